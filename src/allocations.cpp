@@ -0,0 +1,65 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "allocations.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+std::atomic<unsigned long> count ( 0ul );
+}
+
+#ifndef NDEBUG
+
+// debug builds replace the global allocation functions to count allocations,
+// which lets the time loop assert that stepping never touches the heap
+void * operator new ( std::size_t size )
+{
+    ++count;
+    void * ptr = std::malloc ( size ? size : 1u );
+    if ( !ptr ) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void * operator new[] ( std::size_t size )
+{
+    return ::operator new ( size );
+}
+
+void operator delete ( void * ptr ) noexcept
+{
+    std::free ( ptr );
+}
+
+void operator delete[] ( void * ptr ) noexcept
+{
+    std::free ( ptr );
+}
+
+#endif
+
+unsigned long PureMetal::heap_allocations()
+{
+    return count;
+}
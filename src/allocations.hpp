@@ -0,0 +1,31 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PUREMETAL_ALLOCATIONS_HPP
+#define PUREMETAL_ALLOCATIONS_HPP
+
+namespace PureMetal
+{
+
+// number of heap allocations made so far by the program, counted in debug builds only (always 0 with NDEBUG)
+unsigned long heap_allocations();
+
+}
+
+#endif // PUREMETAL_ALLOCATIONS_HPP
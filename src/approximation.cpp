@@ -19,19 +19,51 @@
 
 #include "approximation.hpp"
 
+#include "decomposition.hpp"
 #include "specifications.hpp"
 #include "fulldomainapproximation.hpp"
 #include "quarterdomainapproximation.hpp"
 
-PureMetal::Approximation * PureMetal::Approximation::New ( const SimulationType & simulation_type, const double * upper, const double * lower, const double * spacing )
+PureMetal::Approximation * PureMetal::Approximation::New ( const SimulationType & simulation_type, const double * upper, const double * lower, const double * spacing, Decomposition * decomposition )
 {
+    Approximation * approximation = nullptr;
     switch ( simulation_type ) {
     case SimulationType::full :
-        return new FullDomainApproximation ( upper, lower, spacing );
+        approximation = new FullDomainApproximation ( upper, lower, spacing );
+        break;
     case SimulationType::quadrant :
-        return new QuarterDomainApproximation ( upper, spacing );
+    case SimulationType::octant :
+        approximation = new QuarterDomainApproximation ( upper, spacing );
+        break;
     default :
         return nullptr;
     };
+    approximation->_octant = simulation_type == SimulationType::octant;
+    approximation->_global_size[0] = approximation->_size[0];
+    approximation->_global_size[1] = approximation->_size[1];
+    // a single rank keeps the whole grid and never exchanges ghosts
+    if ( decomposition && decomposition->ranks() > 1 ) {
+        try {
+            decomposition->split ( approximation->_global_size, approximation->_size, approximation->_offset );
+        } catch ( ... ) {
+            delete approximation;
+            throw;
+        }
+        approximation->_decomposition = decomposition;
+        for ( unsigned side = 0u; side < 4u; ++side ) {
+            approximation->_physical[side] = decomposition->physical ( side );
+        }
+    }
+    return approximation;
 }
 
+// global_size cells along each direction, those kept having the same coordinates; decomposed grids are split
+// again, which the fields of the previous size must have been gathered from first
+void PureMetal::Approximation::resize ( const unsigned * global_size )
+{
+    _global_size[0] = _size[0] = global_size[0];
+    _global_size[1] = _size[1] = global_size[1];
+    if ( _decomposition ) {
+        _decomposition->split ( _global_size, _size, _offset );
+    }
+}
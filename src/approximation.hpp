@@ -22,6 +22,8 @@
 
 #include <functional>
 
+#include "threadpool.hpp"
+
 namespace PureMetal
 {
 
@@ -32,13 +34,22 @@ enum class ApproximationType
     Full, QuarterDomain
 };
 
+class Decomposition;
 class Field;
 
+// sizes and indices are those of the block of the grid this rank owns ( the whole grid unless decomposed ),
+// x and y map them to global coordinates
 class Approximation
 {
 protected:
     unsigned _size[2];
+    unsigned _global_size[2];
+    unsigned _offset[2];
     double _spacing[2];
+    ThreadPool * _pool;
+    Decomposition * _decomposition;
+    bool _physical[4];
+    bool _octant;
 
     inline Approximation();
     Approximation ( const Approximation & other ) = delete;
@@ -48,15 +59,29 @@ protected:
 public:
     virtual ~Approximation() = default;
 
-    static Approximation * New ( const SimulationType & simulation_type, const double * upper, const double * lower, const double * spacing );
+    static Approximation * New ( const SimulationType & simulation_type, const double * upper, const double * lower, const double * spacing, Decomposition * decomposition );
+    void resize ( const unsigned * global_size );
     virtual Field * create_field ( const double & ) const = 0;
     virtual Field * create_field ( const std::function<double ( unsigned, unsigned ) > & function ) const = 0;
+    virtual Field * create_field ( double * origin, const unsigned & stride ) const = 0;
 
     virtual ApproximationType type() const = 0;
 
     inline const unsigned & size ( const unsigned & d ) const;
+    inline const unsigned & global_size ( const unsigned & d ) const;
+    inline const unsigned & offset ( const unsigned & d ) const;
     inline const double & spacing ( const unsigned & d ) const;
 
+    inline Decomposition * decomposition() const;
+    inline const bool & physical ( const unsigned & side ) const;
+    inline const bool & octant() const;
+
+    inline void set_pool ( ThreadPool * pool );
+    inline ThreadPool * pool() const;
+    inline unsigned threads() const;
+    template<class Function> inline void parallel_for ( const unsigned & n, const Function & function ) const;
+    template<class Function> inline void parallel_tiles ( const unsigned & n, const Function & function ) const;
+
     virtual unsigned i ( const double & x ) const = 0;
     virtual unsigned j ( const double & x ) const = 0;
 
@@ -67,9 +92,15 @@ public:
 }
 
 PureMetal::Approximation::Approximation( )
+    : _pool ( nullptr ),
+      _decomposition ( nullptr )
 {
     _size[0] = _size[1] = 0u;
+    _global_size[0] = _global_size[1] = 0u;
+    _offset[0] = _offset[1] = 0u;
     _spacing[0] = _spacing[1] = 0.;
+    _physical[0] = _physical[1] = _physical[2] = _physical[3] = true;
+    _octant = false;
 }
 
 const unsigned & PureMetal::Approximation::size ( const unsigned & d ) const
@@ -77,9 +108,77 @@ const unsigned & PureMetal::Approximation::size ( const unsigned & d ) const
     return _size[d];
 }
 
+const unsigned & PureMetal::Approximation::global_size ( const unsigned & d ) const
+{
+    return _global_size[d];
+}
+
+// global index of local index 0
+const unsigned & PureMetal::Approximation::offset ( const unsigned & d ) const
+{
+    return _offset[d];
+}
+
+// nullptr unless the grid is split over several ranks
+PureMetal::Decomposition * PureMetal::Approximation::decomposition() const
+{
+    return _decomposition;
+}
+
+// whether a side ( see Decomposition ) is a boundary of the global grid
+const bool & PureMetal::Approximation::physical ( const unsigned & side ) const
+{
+    return _physical[side];
+}
+
+// whether only the cells above the diagonal, i <= j, are kept up to date, those below it being their
+// images ( see Field::at ); octant quadrants are square and never decomposed
+const bool & PureMetal::Approximation::octant() const
+{
+    return _octant;
+}
+
 const double & PureMetal::Approximation::spacing ( const unsigned & d ) const
 {
     return _spacing[d];
 }
 
+void PureMetal::Approximation::set_pool ( ThreadPool * pool )
+{
+    _pool = pool;
+}
+
+// nullptr for serial loops
+PureMetal::ThreadPool * PureMetal::Approximation::pool() const
+{
+    return _pool;
+}
+
+unsigned PureMetal::Approximation::threads() const
+{
+    return _pool ? _pool->size() : 1u;
+}
+
+// row-parallel loops over fields of this approximation, serial without a pool
+template<class Function>
+void PureMetal::Approximation::parallel_for ( const unsigned & n, const Function & function ) const
+{
+    if ( _pool ) {
+        _pool->parallel_for ( n, function );
+    } else {
+        function ( 0u, n, 0u );
+    }
+}
+
+// as parallel_for, for sweeps whose cost per row varies: idle threads steal rows from the busy ones
+template<class Function>
+void PureMetal::Approximation::parallel_tiles ( const unsigned & n, const Function & function ) const
+{
+    if ( _pool ) {
+        _pool->parallel_tiles ( n, function );
+    } else {
+        function ( 0u, n, 0u );
+    }
+}
+
 #endif // PUREMETAL_APPROXIMATION_HPP
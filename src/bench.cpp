@@ -0,0 +1,129 @@
+#include <cstdio>
+#include <iostream>
+
+#include <boost/property_tree/xml_parser.hpp>
+
+#include "benchmark.hpp"
+#include "benchmarkoptions.hpp"
+#include "messages.hpp"
+#include "simd.hpp"
+#include "specifications.hpp"
+#include "threadpool.hpp"
+
+using namespace PureMetal;
+
+namespace
+{
+
+const char * layout_name ( const LayoutType & layout )
+{
+    return layout == LayoutType::interleaved ? "interleaved" : "separate";
+}
+
+const char * simd_name ( const SimdType & simd )
+{
+    switch ( simd ) {
+    case SimdType::avx2 :
+        return "avx2";
+    case SimdType::avx512 :
+        return "avx512";
+    default :
+        return "scalar";
+    }
+}
+
+// approximations have 1 + ceil ( extent / spacing ) nodes per direction: half a spacing short of
+// n - 1 spacings gives n nodes whatever the rounding
+void set_grid ( boost::property_tree::ptree & document, const Specifications * specifications, const unsigned & n, const unsigned & m )
+{
+    const double * spacing = specifications->spacing();
+    double extent[2] = { ( n - 1.5 ) * spacing[0], ( m - 1.5 ) * spacing[1] };
+    char bounds[64];
+    if ( specifications->simulation_type() == SimulationType::full ) {
+        std::snprintf ( bounds, sizeof ( bounds ), "[%.17g, %.17g]", -.5 * extent[0], -.5 * extent[1] );
+        document.put ( "PureMetal_specification.Grid.lower", bounds );
+        extent[0] *= .5;
+        extent[1] *= .5;
+    }
+    std::snprintf ( bounds, sizeof ( bounds ), "[%.17g, %.17g]", extent[0], extent[1] );
+    document.put ( "PureMetal_specification.Grid.upper", bounds );
+}
+
+}
+
+int main ( int argc, char ** argv )
+{
+    BenchmarkOptions * options = nullptr;
+    Specifications * specifications = nullptr;
+    boost::property_tree::ptree document;
+
+    try {
+        options = new BenchmarkOptions ( argc, argv );
+    } catch ( const std::exception & e ) {
+        std::cerr << e.what() << std::endl;
+        benchmark_usage ( std::cout );
+        delete options;
+        return 1;
+    }
+
+    try {
+        boost::property_tree::read_xml ( options->input_file(), document );
+        // field and tip files would only time the disk: the postprocessors are timed on their own
+        document.put ( "PureMetal_specification.DataArchiver.outputTimestepInterval", 0u );
+        document.put ( "PureMetal_specification.PhaseField.postprocess_polynomial", false );
+        document.put ( "PureMetal_specification.PhaseField.postprocess_cspline", false );
+        if ( document.get_child_optional ( "PureMetal_specification.CoarseDiffusion.<xmlattr>.validate" ) ) {
+            document.put ( "PureMetal_specification.CoarseDiffusion.<xmlattr>.validate", false );
+        }
+        specifications = new Specifications ( document );
+    } catch ( const std::exception & e ) {
+        std::cerr << e.what() << std::endl;
+        parse_error ( std::cout, options->input_file() );
+        delete specifications;
+        delete options;
+        return 1;
+    }
+
+    ThreadPool * pool = new ThreadPool ( specifications->threads() );
+
+    std::cout << "{\n";
+    std::cout << "  \"input\": \"" << options->input_file() << "\",\n";
+    std::cout << "  \"threads\": " << pool->size() << ",\n";
+    std::cout << "  \"simd\": \"" << simd_name ( simd_type() ) << "\",\n";
+    std::cout << "  \"layout\": \"" << layout_name ( specifications->layout() ) << "\",\n";
+    std::cout << "  \"warmup\": " << options->warmup() << ",\n";
+    std::cout << "  \"repeats\": " << options->repeats() << ",\n";
+    std::cout << "  \"sweeps\": " << options->sweeps() << ",\n";
+    std::cout << "  \"runs\": [\n";
+
+    const std::vector<unsigned> & grids = options->grids();
+    for ( unsigned g = 0u; g == 0u || g < grids.size(); g += 2u ) {
+        try {
+            if ( grids.size() ) {
+                set_grid ( document, specifications, grids[g], grids[g + 1u] );
+                delete specifications;
+                specifications = nullptr;
+                specifications = new Specifications ( document );
+            }
+            Benchmark benchmark ( specifications, pool, options->warmup(), options->repeats(), options->sweeps() );
+            benchmark.run();
+            std::cout << ( g ? ",\n" : "" );
+            benchmark.write ( std::cout );
+        } catch ( const std::exception & e ) {
+            std::cerr << e.what() << std::endl;
+            delete pool;
+            delete specifications;
+            delete options;
+            return 1;
+        }
+    }
+
+    std::cout << "\n  ]\n";
+    std::cout << "}" << std::endl;
+
+    delete pool;
+    delete specifications;
+    delete options;
+
+    return 0;
+}
@@ -0,0 +1,183 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+#include "approximation.hpp"
+#include "csplinepostprocessor.hpp"
+#include "field.hpp"
+#include "messages.hpp"
+#include "polynomialpostprocessor.hpp"
+#include "simulation.hpp"
+#include "specifications.hpp"
+
+PureMetal::Benchmark::Benchmark ( const Specifications * specs, ThreadPool * pool, const unsigned & warmup, const unsigned & repeats, const unsigned & sweeps )
+    : _specs ( specs ),
+      _pool ( pool ),
+      _warmup ( warmup ),
+      _repeats ( repeats ),
+      _sweeps ( sweeps ),
+      _results ()
+{
+    _size[0] = _size[1] = 0u;
+}
+
+PureMetal::Benchmark::Result::~Result() = default;
+
+// bandwidths count the compulsory traffic only: each field the sweep reads or writes crosses memory once
+void PureMetal::Benchmark::run()
+{
+    Approximation * approximation = Approximation::New ( _specs->simulation_type(), _specs->upper(), _specs->lower(), _specs->spacing(), nullptr );
+    approximation->set_pool ( _pool );
+    _size[0] = approximation->size ( 0 );
+    _size[1] = approximation->size ( 1 );
+    const double cells = static_cast<double> ( _size[0] ) * _size[1];
+    const double delt = _specs->time_type() == TimeType::stable ? _specs->delt_max() : _specs->delt();
+    const double & r0 = _specs->r0();
+    const double & gamma_psi = _specs->gamma_psi();
+    _results.clear();
+
+    {
+        Simulation simulation ( _specs, _pool, nullptr );
+        simulation.start ( delt, std::numeric_limits<unsigned>::max() - 1u );
+        // the first step configures the kernel, tuning included, outside the timings
+        simulation.next();
+        measure ( "next_ts", cells, 4. * sizeof ( double ) * cells, [ & ]() -> unsigned {
+            const unsigned ts = simulation.timestep();
+            simulation.next();
+            return simulation.timestep() - ts;
+        } );
+        // stable reduces the bounds the kernel kept while stepping, it sweeps no cells
+        measure ( "stable", 0., 0., [ & ]() -> unsigned {
+            simulation.stable();
+            return 1u;
+        } );
+    }
+
+    // the initial seed of Simulation::start, so that the postprocessors find a tip at r0
+    Field * psi = approximation->create_field ( [ & ] ( unsigned i, unsigned j ) -> double {
+        double x = approximation->x ( i ), y = approximation->y ( j );
+        return -std::tanh ( gamma_psi * ( x * x + y * y - r0 * r0 ) );
+    } );
+    Field * laplacian = approximation->create_field ( 0. );
+    measure ( "laplacian", cells, 2. * sizeof ( double ) * cells, [ & ]() -> unsigned {
+        laplacian->update ( [ & ] ( unsigned i, unsigned j ) -> double {
+            return psi->laplacian ( i, j );
+        } );
+        return 1u;
+    } );
+    delete laplacian;
+
+    // tips are only located on quadrants
+    if ( _specs->simulation_type() != SimulationType::quadrant ) {
+        delete psi;
+        delete approximation;
+        return;
+    }
+    const std::string path = _specs->out_path() + "/bench";
+    std::string cmd = "mkdir -p " + path;
+    if ( std::system ( cmd.c_str() ) == -1 ) {
+        delete psi;
+        delete approximation;
+        throw std::runtime_error ( output_dir_error_msg + path );
+    }
+    unsigned ts = 0u;
+    PostProcessor * post_processors[2] = {
+        new PolynomialPostProcessor ( r0, path, "tip_polynomial", false, false ),
+        new CSPLinePostProcessor ( r0, path, "tip_cspline", false, false )
+    };
+    const char * names[2] = { "process_polynomial", "process_cspline" };
+    for ( unsigned p = 0u; p < 2u; ++p ) {
+        measure ( names[p], 0., 0., [ & ]() -> unsigned {
+            ++ts;
+            post_processors[p]->process ( approximation, ts, ts * delt, psi, delt, 1u );
+            return 1u;
+        } );
+        delete post_processors[p];
+    }
+
+    delete psi;
+    delete approximation;
+}
+
+// one JSON object per grid: seconds per sweep over the repeats, with throughput and bandwidth at the median
+void PureMetal::Benchmark::write ( std::ostream & os ) const
+{
+    os << "    {\n";
+    os << "      \"grid\": [" << _size[0] << ", " << _size[1] << "],\n";
+    os << "      \"benchmarks\": [";
+    bool first = true;
+    for ( const Result & result : _results ) {
+        std::vector<double> seconds ( result.seconds );
+        std::sort ( seconds.begin(), seconds.end() );
+        const unsigned n = seconds.size();
+        const double median = n % 2u ? seconds[n / 2u] : .5 * ( seconds[n / 2u - 1u] + seconds[n / 2u] );
+        const double mean = std::accumulate ( seconds.begin(), seconds.end(), 0. ) / n;
+        double variance = 0.;
+        for ( const double & s : seconds ) {
+            variance += ( s - mean ) * ( s - mean ) / n;
+        }
+
+        os << ( first ? "\n" : ",\n" );
+        os << "        {\n";
+        os << "          \"name\": \"" << result.name << "\",\n";
+        os << "          \"seconds\": { \"min\": " << seconds.front() << ", \"median\": " << median
+           << ", \"mean\": " << mean << ", \"stddev\": " << std::sqrt ( variance ) << " },\n";
+        os << "          \"mlups\": ";
+        if ( result.updates > 0. ) {
+            os << result.updates / median * 1e-6;
+        } else {
+            os << "null";
+        }
+        os << ",\n";
+        os << "          \"bandwidth_gbs\": ";
+        if ( result.bytes > 0. ) {
+            os << result.bytes / median * 1e-9;
+        } else {
+            os << "null";
+        }
+        os << ",\n";
+        // busy and idle seconds per thread over all the repeats, the closer they are the better the balance
+        os << "          \"threads\": ";
+        if ( result.threads.empty() ) {
+            os << "null";
+        } else {
+            os << "[";
+            for ( unsigned thread = 0u; thread < result.threads.size(); ++thread ) {
+                const ThreadPool::Statistics & statistics = result.threads[thread];
+                os << ( thread ? ",\n" : "\n" );
+                os << "            { \"busy\": " << statistics.busy << ", \"idle\": " << statistics.idle
+                   << ", \"tiles\": " << statistics.tiles << ", \"steals\": " << statistics.steals << " }";
+            }
+            os << "\n          ]";
+        }
+        os << "\n";
+        os << "        }";
+        first = false;
+    }
+    os << "\n      ]\n";
+    os << "    }";
+}
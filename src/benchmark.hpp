@@ -0,0 +1,103 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PUREMETAL_BENCHMARK_HPP
+#define PUREMETAL_BENCHMARK_HPP
+
+#include <chrono>
+#include <list>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "threadpool.hpp"
+
+namespace PureMetal
+{
+
+class Specifications;
+
+// times the solver components on the grid of a specification, without parsing, field output or
+// tip files in the way; every measurement reports seconds per sweep over the lattice
+class Benchmark
+{
+    struct Result {
+        std::string name;
+        double updates; // lattice updates per sweep, 0 when the sweep updates no lattice
+        double bytes; // compulsory memory traffic per sweep
+        std::vector<double> seconds; // per sweep, one entry per repeat
+        std::vector<ThreadPool::Statistics> threads; // over all repeats, empty when the sweep is not tiled
+
+        // out of line: measure instantiations destroy results on their unwinding paths too
+        ~Result();
+    };
+
+    const Specifications * _specs;
+    ThreadPool * _pool;
+    const unsigned _warmup;
+    const unsigned _repeats;
+    const unsigned _sweeps;
+    unsigned _size[2];
+    std::list<Result> _results;
+
+    Benchmark ( const Benchmark & other ) = delete;
+    Benchmark & operator= ( const Benchmark & other ) = delete;
+    bool operator== ( const Benchmark & other ) const = delete;
+
+    template<class Function> inline void measure ( const std::string & name, const double & updates, const double & bytes, const Function & function );
+
+public:
+    Benchmark ( const Specifications * specs, ThreadPool * pool, const unsigned & warmup, const unsigned & repeats, const unsigned & sweeps );
+    ~Benchmark() = default;
+
+    void run();
+    void write ( std::ostream & os ) const;
+};
+
+}
+
+// function performs one call and returns the number of sweeps it did; each repeat
+// times calls until at least _sweeps sweeps are done
+template<class Function>
+void PureMetal::Benchmark::measure ( const std::string & name, const double & updates, const double & bytes, const Function & function )
+{
+    for ( unsigned sweeps = 0u; sweeps < _warmup; ) {
+        sweeps += function();
+    }
+    Result result { name, updates, bytes, std::vector<double> ( _repeats ), std::vector<ThreadPool::Statistics>() };
+    _pool->reset_statistics();
+    for ( double & seconds : result.seconds ) {
+        unsigned sweeps = 0u;
+        auto begin = std::chrono::steady_clock::now();
+        while ( sweeps < _sweeps ) {
+            sweeps += function();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+        seconds = elapsed.count() / sweeps;
+    }
+    for ( unsigned thread = 0u; thread < _pool->size(); ++thread ) {
+        result.threads.push_back ( _pool->statistics ( thread ) );
+    }
+    if ( !result.threads[0].tiles ) {
+        result.threads.clear();
+    }
+    _results.push_back ( result );
+}
+
+#endif // PUREMETAL_BENCHMARK_HPP
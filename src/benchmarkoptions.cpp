@@ -0,0 +1,61 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "benchmarkoptions.hpp"
+
+#include <cstdio>
+#include <stdexcept>
+
+#include "messages.hpp"
+
+// pure_metal_bench [--warmup <n>] [--repeats <n>] [--sweeps <n>] [--grid <Nx>x<Ny>]... <input>.xml
+PureMetal::BenchmarkOptions::BenchmarkOptions ( int argc, char ** argv ) :
+    _input_file ( "" ),
+    _warmup ( 2u ),
+    _repeats ( 5u ),
+    _sweeps ( 10u ),
+    _grids ()
+{
+    if ( argc < 2 || argc % 2 ) {
+        throw std::runtime_error ( options_number_error_msg );
+    }
+    for ( int arg = 1; arg < argc - 1; arg += 2 ) {
+        std::string option = std::string ( argv[arg] );
+        std::string value = std::string ( argv[arg + 1] );
+        unsigned n, m;
+        char end;
+        if ( option == "--grid" ) {
+            if ( std::sscanf ( value.c_str(), "%ux%u%c", &n, &m, &end ) != 2 || n < 2u || m < 2u ) {
+                throw std::runtime_error ( invalid_option_value_msg + option + " " + value );
+            }
+            _grids.push_back ( n );
+            _grids.push_back ( m );
+        } else if ( option == "--warmup" || option == "--repeats" || option == "--sweeps" ) {
+            if ( std::sscanf ( value.c_str(), "%u%c", &n, &end ) != 1 || ( n == 0u && option != "--warmup" ) ) {
+                throw std::runtime_error ( invalid_option_value_msg + option + " " + value );
+            }
+            ( option == "--warmup" ? _warmup : option == "--repeats" ? _repeats : _sweeps ) = n;
+        } else {
+            throw std::runtime_error ( unknown_option_msg + option );
+        }
+    }
+    _input_file = std::string ( argv[argc - 1] );
+}
+
+PureMetal::BenchmarkOptions::~BenchmarkOptions() = default;
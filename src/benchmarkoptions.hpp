@@ -0,0 +1,79 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PUREMETAL_BENCHMARKOPTIONS_HPP
+#define PUREMETAL_BENCHMARKOPTIONS_HPP
+
+#include <string>
+#include <vector>
+
+namespace PureMetal
+{
+
+class BenchmarkOptions
+{
+    std::string _input_file;
+    unsigned _warmup;
+    unsigned _repeats;
+    unsigned _sweeps;
+    std::vector<unsigned> _grids; // Nx and Ny of each grid, none for the grid of the input
+
+    BenchmarkOptions ( const BenchmarkOptions & other ) = delete;
+    BenchmarkOptions & operator= ( const BenchmarkOptions & other ) = delete;
+    bool operator== ( const BenchmarkOptions & other ) const = delete;
+
+public:
+    BenchmarkOptions ( int argc, char ** argv );
+    ~BenchmarkOptions();
+
+    inline const std::string & input_file () const;
+    inline const unsigned & warmup () const;
+    inline const unsigned & repeats () const;
+    inline const unsigned & sweeps () const;
+    inline const std::vector<unsigned> & grids () const;
+};
+
+inline const std::string & BenchmarkOptions::input_file () const
+{
+    return _input_file;
+}
+
+inline const unsigned & BenchmarkOptions::warmup () const
+{
+    return _warmup;
+}
+
+inline const unsigned & BenchmarkOptions::repeats () const
+{
+    return _repeats;
+}
+
+inline const unsigned & BenchmarkOptions::sweeps () const
+{
+    return _sweeps;
+}
+
+inline const std::vector<unsigned> & BenchmarkOptions::grids () const
+{
+    return _grids;
+}
+
+}
+
+#endif // PUREMETAL_BENCHMARKOPTIONS_HPP
@@ -0,0 +1,69 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PUREMETAL_BOUNDARY_HPP
+#define PUREMETAL_BOUNDARY_HPP
+
+namespace PureMetal
+{
+
+class ReflectingBoundary
+{
+    ReflectingBoundary() = delete;
+
+public:
+    inline static int index ( const int & k, const int & N );
+    inline static void fill ( double * row, const int & N, const int & halo );
+    inline static void fill_lower ( double * row, const int & N, const int & halo );
+    inline static void fill_upper ( double * row, const int & N, const int & halo );
+};
+
+}
+
+// interior index mirrored by k, for -N < k < 2N - 1
+int PureMetal::ReflectingBoundary::index ( const int & k, const int & N )
+{
+    return k < 0 ? -k : ( k >= N ? 2 * N - k - 2 : k );
+}
+
+// fills the halo ghost cells at both ends of a row of N interior values
+void PureMetal::ReflectingBoundary::fill ( double * row, const int & N, const int & halo )
+{
+    for ( int k = 1; k <= halo; ++k ) {
+        row[-k] = row[k];
+        row[N - 1 + k] = row[N - 1 - k];
+    }
+}
+
+// one end only, where the other borders a neighbouring block ( see Decomposition )
+void PureMetal::ReflectingBoundary::fill_lower ( double * row, const int & N, const int & halo )
+{
+    for ( int k = 1; k <= halo; ++k ) {
+        row[-k] = row[k];
+    }
+}
+
+void PureMetal::ReflectingBoundary::fill_upper ( double * row, const int & N, const int & halo )
+{
+    for ( int k = 1; k <= halo; ++k ) {
+        row[N - 1 + k] = row[N - 1 - k];
+    }
+}
+
+#endif // PUREMETAL_BOUNDARY_HPP
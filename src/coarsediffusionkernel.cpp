@@ -0,0 +1,242 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "coarsediffusionkernel.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "approximation.hpp"
+#include "boundary.hpp"
+#include "field.hpp"
+#include "messages.hpp"
+
+PureMetal::CoarseDiffusionKernel::CoarseDiffusionKernel ( Kernel * explicit_kernel, const Approximation * approximation, const SimulationType & simulation_type, const double & alpha,
+        const unsigned & factor )
+    : _approximation ( approximation ),
+      _alpha ( alpha ),
+      _factor ( factor ),
+      _explicit ( explicit_kernel ),
+      _coarse ( nullptr ),
+      _u0 ( nullptr ),
+      _u ( nullptr ),
+      _nodes { nullptr, nullptr },
+      _weights ( nullptr ),
+      _row_size ( approximation->size ( 0 ) ),
+      _rows ( nullptr ),
+      _bounds ( nullptr )
+{
+    if ( !explicit_kernel->leave_u() ) {
+        delete explicit_kernel;
+        throw std::runtime_error ( coarse_diffusion_msg );
+    }
+    const unsigned & Nx = approximation->size ( 0 );
+    const unsigned & Ny = approximation->size ( 1 );
+    // the coarse grid spans the same coordinates, its nodes those of the grid every factor nodes: spaced
+    // factor times wider, both grids share their nodes once they share the last one
+    const unsigned size[2] = { ( Nx - 1u ) / factor + 1u, ( Ny - 1u ) / factor + 1u };
+    if ( !approximation->decomposition() && ! ( ( Nx - 1u ) % factor ) && ! ( ( Ny - 1u ) % factor ) ) {
+        const double upper[2] = { approximation->x ( Nx - 1u ), approximation->y ( Ny - 1u ) };
+        const double lower[2] = { upper[0] - ( Nx - 1u ) * approximation->spacing ( 0 ), upper[1] - ( Ny - 1u ) * approximation->spacing ( 1 ) };
+        const double spacing[2] = { factor * approximation->spacing ( 0 ), factor * approximation->spacing ( 1 ) };
+        _coarse = Approximation::New ( simulation_type, upper, lower, spacing, nullptr );
+        _coarse->resize ( size );
+    }
+    if ( !_coarse || _coarse->x ( size[0] - 1u ) != approximation->x ( Nx - 1u ) || _coarse->y ( size[1] - 1u ) != approximation->y ( Ny - 1u ) ) {
+        delete _coarse;
+        delete explicit_kernel;
+        throw std::runtime_error ( coarse_grid_msg );
+    }
+    _coarse->set_pool ( approximation->pool() );
+    _u0 = _coarse->create_field ( 0. );
+    _u = _coarse->create_field ( 0. );
+
+    // full weighting: tent weights ( factor - |k| ) / factor^2 along each direction, summing to 1
+    const int f = factor, width = 2 * f - 1;
+    _weights = new double[width];
+    for ( int k = 1 - f; k < f; ++k ) {
+        _weights[k + f - 1] = static_cast<double> ( f - std::abs ( k ) ) / static_cast<double> ( f * f );
+    }
+    for ( unsigned d = 0u; d < 2u; ++d ) {
+        const int n = _coarse->size ( d ), N = approximation->size ( d );
+        _nodes[d] = new int[n * width];
+        for ( int I = 0; I < n; ++I ) {
+            for ( int k = 1 - f; k < f; ++k ) {
+                _nodes[d][I * width + k + f - 1] = ReflectingBoundary::index ( f * I + k, N );
+            }
+        }
+    }
+    _rows = new double[_row_size * approximation->threads()];
+    _bounds = new double[2u * approximation->threads()];
+    // no step has written u yet, bounds() reports none until one does
+    for ( unsigned thread = 0u; thread < approximation->threads(); ++thread ) {
+        _bounds[2u * thread] = _bounds[2u * thread + 1u] = std::numeric_limits<double>::quiet_NaN();
+    }
+}
+
+PureMetal::CoarseDiffusionKernel::~CoarseDiffusionKernel()
+{
+    delete [] _bounds;
+    delete [] _rows;
+    delete [] _nodes[1];
+    delete [] _nodes[0];
+    delete [] _weights;
+    delete _u;
+    delete _u0;
+    delete _coarse;
+    delete _explicit;
+}
+
+unsigned PureMetal::CoarseDiffusionKernel::configure ( const unsigned & tile_rows, const unsigned & , const double & delt, Field * psi0, Field * u0, Field * psi, Field * u )
+{
+    return _explicit->configure ( tile_rows, 1u, delt, psi0, u0, psi, u );
+}
+
+// u0 is the interpolation of the last coarse u, or the initial u, so injection gives the coarse u0 back
+// without keeping it across steps, which adaptive runs may reject and grids may be shifted under. The
+// explicit step only writes psi, u being interpolated once the coarse u is stepped
+void PureMetal::CoarseDiffusionKernel::step ( const double & delt, const unsigned & , Field * psi0, Field * u0, Field * psi, Field * u )
+{
+    const unsigned & Nx = _approximation->size ( 0 );
+    const unsigned & Ny = _approximation->size ( 1 );
+    const int & nx = _coarse->size ( 0 );
+    const unsigned & ny = _coarse->size ( 1 );
+    const unsigned & f = _factor;
+    const unsigned width = 2u * f - 1u;
+    _explicit->step ( delt, 1u, psi0, u0, psi, u );
+    _coarse->parallel_for ( ny, [ & ] ( const unsigned & J0, const unsigned & J1, const unsigned & ) {
+        for ( unsigned J = J0; J < J1; ++J ) {
+            const double * v0 = u0->data() + f * J * u0->stride();
+            double * c0 = _u0->data() + J * _u0->stride();
+            for ( int I = 0; I < nx; ++I ) {
+                c0[I] = v0[f * I];
+            }
+        }
+    } );
+    _u0->fill_boundary();
+    // the laplacian of the grid divides by its spacing, so that of the coarse grid divides by factor^2 times it
+    const double hx = f * f * _approximation->spacing ( 0 );
+    const double hy = f * f * _approximation->spacing ( 1 );
+    const int s = _u0->stride();
+    _coarse->parallel_tiles ( ny, [ & ] ( const unsigned & J0, const unsigned & J1, const unsigned & thread ) {
+        double * row = _rows + thread * _row_size;
+        for ( unsigned J = J0; J < J1; ++J ) {
+            // ( psi - psi0 ) / 2 weighed along y over the rows around J, then along x around each coarse node
+            std::fill ( row, row + Nx, 0. );
+            for ( unsigned b = 0u; b < width; ++b ) {
+                const unsigned j = _nodes[1][J * width + b];
+                const double w = _weights[b] / 2.;
+                const double * p = psi->data() + j * psi->stride(), * p0 = psi0->data() + j * psi0->stride();
+                for ( unsigned i = 0u; i < Nx; ++i ) {
+                    row[i] += w * ( p[i] - p0[i] );
+                }
+            }
+            const double * c0 = _u0->data() + J * s;
+            double * c = _u->data() + J * s;
+            for ( int I = 0; I < nx; ++I ) {
+                const int * nodes = _nodes[0] + I * width;
+                double source = 0.;
+                for ( unsigned a = 0u; a < width; ++a ) {
+                    source += _weights[a] * row[nodes[a]];
+                }
+                const double lap_u = ( c0[I + 1] + c0[I - 1] - 2 * c0[I] ) / hx + ( c0[I + s] + c0[I - s] - 2 * c0[I] ) / hy;
+                c[I] = c0[I] + delt * _alpha * lap_u + source;
+            }
+        }
+    } );
+    _u->fill_boundary();
+    // bilinear interpolation into u, whose last row and column fall on coarse nodes
+    for ( unsigned thread = 0u; thread < _approximation->threads(); ++thread ) {
+        _bounds[2u * thread] = std::numeric_limits<double>::infinity();
+        _bounds[2u * thread + 1u] = -std::numeric_limits<double>::infinity();
+    }
+    _approximation->parallel_for ( Ny, [ & ] ( const unsigned & j0, const unsigned & j1, const unsigned & thread ) {
+        double min = _bounds[2u * thread], max = _bounds[2u * thread + 1u];
+        for ( unsigned j = j0; j < j1; ++j ) {
+            const double wy = static_cast<double> ( j % f ) / f;
+            const double * c = _u->data() + ( j / f ) * s;
+            double * v = u->data() + j * u->stride();
+            for ( unsigned i = 0u; i < Nx; ++i ) {
+                const unsigned I = i / f;
+                const double wx = static_cast<double> ( i % f ) / f;
+                v[i] = ( 1. - wy ) * ( ( 1. - wx ) * c[I] + wx * c[I + 1] ) + wy * ( ( 1. - wx ) * c[I + s] + wx * c[I + s + 1] );
+                min = v[i] < min ? v[i] : min;
+                max = v[i] > max ? v[i] : max;
+            }
+        }
+        _bounds[2u * thread] = min;
+        _bounds[2u * thread + 1u] = max;
+    } );
+    u->fill_boundary();
+}
+
+bool PureMetal::CoarseDiffusionKernel::bounds ( double & min, double & max ) const
+{
+    min = _bounds[0];
+    max = _bounds[1];
+    for ( unsigned thread = 1u; thread < _approximation->threads(); ++thread ) {
+        min = _bounds[2u * thread] < min ? _bounds[2u * thread] : min;
+        max = _bounds[2u * thread + 1u] > max ? _bounds[2u * thread + 1u] : max;
+    }
+    return ! std::isnan ( min );
+}
+
+double PureMetal::CoarseDiffusionKernel::max_a2() const
+{
+    return _explicit->max_a2();
+}
+
+void PureMetal::CoarseDiffusionKernel::narrow_band ( const double & delta, const unsigned & margin, const unsigned & interval )
+{
+    _explicit->narrow_band ( delta, margin, interval );
+}
+
+double PureMetal::CoarseDiffusionKernel::active_fraction() const
+{
+    return _explicit->active_fraction();
+}
+
+void PureMetal::CoarseDiffusionKernel::invalidate()
+{
+    _explicit->invalidate();
+}
+
+// u is interpolated from the coarse grid after the explicit step: the monitor sweeps it
+void PureMetal::CoarseDiffusionKernel::watch_divergence()
+{
+}
+
+bool PureMetal::CoarseDiffusionKernel::divergence ( double &, double & ) const
+{
+    return false;
+}
+
+// u is already held by this kernel
+bool PureMetal::CoarseDiffusionKernel::leave_u()
+{
+    return false;
+}
+
+void PureMetal::CoarseDiffusionKernel::derive ( const Field * psi, Field * psix, Field * psiy, Field * n2, Field * a, Field * a2, Field * bxy ) const
+{
+    _explicit->derive ( psi, psix, psiy, n2, a, a2, bxy );
+}
@@ -0,0 +1,77 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PUREMETAL_COARSEDIFFUSIONKERNEL_HPP
+#define PUREMETAL_COARSEDIFFUSIONKERNEL_HPP
+
+#include "kernel.hpp"
+
+namespace PureMetal
+{
+
+enum class SimulationType;
+
+// explicit steps with u on a grid factor times coarser than psi, whose nodes are every factor nodes of
+// the grid. psi alone is stepped by the explicit kernel ( see Kernel::leave_u ), from the fine u, which
+// is only the bilinear interpolation of the coarse one: the coarse u is taken back from u0 at the nodes
+// they share, diffused with the coarse spacing and fed ( psi - psi0 ) / 2 restricted by full weighting,
+// then interpolated into u again. Diffusion bounds delt by the coarse spacing: factor^2 times less than
+// by the grid
+class CoarseDiffusionKernel : public Kernel
+{
+    const Approximation * _approximation;
+    const double _alpha;
+    const unsigned _factor;
+    Kernel * _explicit;
+    Approximation * _coarse;
+    Field * _u0;
+    Field * _u;
+    // per coarse node, the 2 factor - 1 nodes of the grid it weighs, mirrored into it, and their weights
+    int * _nodes[2];
+    double * _weights;
+    unsigned _row_size;
+    double * _rows;
+    double * _bounds;
+
+    CoarseDiffusionKernel ( const CoarseDiffusionKernel & other ) = delete;
+    CoarseDiffusionKernel & operator= ( const CoarseDiffusionKernel & other ) = delete;
+    bool operator== ( const CoarseDiffusionKernel & other ) const = delete;
+
+public:
+    // takes ownership of explicit_kernel; whole grids only, with nodes every factor nodes from their centre to their edges
+    CoarseDiffusionKernel ( Kernel * explicit_kernel, const Approximation * approximation, const SimulationType & simulation_type, const double & alpha, const unsigned & factor );
+    ~CoarseDiffusionKernel();
+
+    // steps are never blocked: each needs the whole coarse u before the next
+    unsigned configure ( const unsigned & tile_rows, const unsigned & depth, const double & delt, Field * psi0, Field * u0, Field * psi, Field * u ) override;
+    void step ( const double & delt, const unsigned & steps, Field * psi0, Field * u0, Field * psi, Field * u ) override;
+    bool bounds ( double & min, double & max ) const override;
+    double max_a2() const override;
+    void narrow_band ( const double & delta, const unsigned & margin, const unsigned & interval ) override;
+    double active_fraction() const override;
+    void invalidate() override;
+    void watch_divergence() override;
+    bool divergence ( double & energy, double & change ) const override;
+    bool leave_u() override;
+    void derive ( const Field * psi, Field * psix, Field * psiy, Field * n2, Field * a, Field * a2, Field * bxy ) const override;
+};
+
+}
+
+#endif // PUREMETAL_COARSEDIFFUSIONKERNEL_HPP
@@ -0,0 +1,112 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "cosinesolver.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "approximation.hpp"
+#include "field.hpp"
+
+PureMetal::CosineSolver::CosineSolver ( const Approximation * approximation )
+    : _approximation ( approximation ),
+      _workspaces ( new gsl_fft_real_workspace * [2u * approximation->threads()] ),
+      _buffer_size ( 2u * ( std::max ( approximation->size ( 0 ), approximation->size ( 1 ) ) - 1u ) ),
+      _buffers ( new double[_buffer_size * approximation->threads()] )
+{
+    for ( unsigned direction = 0u; direction < 2u; ++direction ) {
+        const unsigned & n = _approximation->size ( direction );
+        const double & h = _approximation->spacing ( direction );
+        _eigenvalues[direction] = new double[n];
+        for ( unsigned k = 0u; k < n; ++k ) {
+            _eigenvalues[direction][k] = ( 2. * std::cos ( M_PI * k / ( n - 1u ) ) - 2. ) / h;
+        }
+        _wavetables[direction] = gsl_fft_real_wavetable_alloc ( 2u * ( n - 1u ) );
+        for ( unsigned thread = 0u; thread < _approximation->threads(); ++thread ) {
+            _workspaces[2u * thread + direction] = gsl_fft_real_workspace_alloc ( 2u * ( n - 1u ) );
+        }
+    }
+}
+
+PureMetal::CosineSolver::~CosineSolver()
+{
+    for ( unsigned direction = 0u; direction < 2u; ++direction ) {
+        for ( unsigned thread = 0u; thread < _approximation->threads(); ++thread ) {
+            gsl_fft_real_workspace_free ( _workspaces[2u * thread + direction] );
+        }
+        gsl_fft_real_wavetable_free ( _wavetables[direction] );
+        delete [] _eigenvalues[direction];
+    }
+    delete [] _workspaces;
+    delete [] _buffers;
+}
+
+// the cosine transform of the n values stride apart, in place: the real parts of the FFT of the extension
+// v0 .. v(n-1) v(n-2) .. v1, which are its only nonzero parts
+void PureMetal::CosineSolver::transform ( const unsigned & direction, double * values, const unsigned & stride, const unsigned & thread ) const
+{
+    const unsigned & n = _approximation->size ( direction );
+    const unsigned m = 2u * ( n - 1u );
+    double * buffer = _buffers + thread * _buffer_size;
+    for ( unsigned k = 0u; k < n; ++k ) {
+        buffer[k] = values[k * stride];
+    }
+    for ( unsigned k = 1u; k + 1u < n; ++k ) {
+        buffer[m - k] = values[k * stride];
+    }
+    gsl_fft_real_transform ( buffer, 1u, m, _wavetables[direction], _workspaces[2u * thread + direction] );
+    // half complex order: the real part of mode k < m / 2 is at 2k - 1, that of mode m / 2 last
+    values[0] = buffer[0];
+    for ( unsigned k = 1u; k + 1u < n; ++k ) {
+        values[k * stride] = buffer[2u * k - 1u];
+    }
+    values[( n - 1u ) * stride] = buffer[m - 1u];
+}
+
+// rows are transformed, then each column is transformed, divided by the eigenvalues of I - c L and
+// transformed back while in cache, and rows are transformed back
+void PureMetal::CosineSolver::solve ( const double & c, Field * field ) const
+{
+    const unsigned & Nx = _approximation->size ( 0 );
+    const unsigned & Ny = _approximation->size ( 1 );
+    const unsigned & stride = field->stride();
+    double * x = field->data();
+    const double scale = 1. / ( 4. * ( Nx - 1u ) * ( Ny - 1u ) );
+    _approximation->parallel_tiles ( Ny, [ & ] ( const unsigned & j0, const unsigned & j1, const unsigned & thread ) {
+        for ( unsigned j = j0; j < j1; ++j ) {
+            transform ( 0u, x + j * stride, 1u, thread );
+        }
+    } );
+    _approximation->parallel_tiles ( Nx, [ & ] ( const unsigned & i0, const unsigned & i1, const unsigned & thread ) {
+        for ( unsigned i = i0; i < i1; ++i ) {
+            transform ( 1u, x + i, stride, thread );
+            for ( unsigned j = 0u; j < Ny; ++j ) {
+                x[i + j * stride] *= scale / ( 1. - c * ( _eigenvalues[0][i] + _eigenvalues[1][j] ) );
+            }
+            transform ( 1u, x + i, stride, thread );
+        }
+    } );
+    _approximation->parallel_tiles ( Ny, [ & ] ( const unsigned & j0, const unsigned & j1, const unsigned & thread ) {
+        for ( unsigned j = j0; j < j1; ++j ) {
+            transform ( 0u, x + j * stride, 1u, thread );
+        }
+    } );
+}
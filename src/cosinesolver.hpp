@@ -0,0 +1,63 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef PUREMETAL_COSINESOLVER_HPP
+#define PUREMETAL_COSINESOLVER_HPP
+
+#include <gsl/gsl_fft_real.h>
+
+namespace PureMetal
+{
+
+class Approximation;
+class Field;
+
+// solves ( I - c L ) x = b for the laplacian L of the kernels, whose differences are divided by the
+// spacing, with the reflecting boundaries of the fields. These mirror about the boundary cells, so the
+// cosine transform of type I diagonalises L along each direction: on N cells mode k has eigenvalue
+// ( 2 cos ( pi k / ( N - 1 ) ) - 2 ) / h. Transforms are real FFTs of the even extensions, of length
+// 2 ( N - 1 ), and are their own inverses up to that factor. Rows and columns are spread over the threads
+class CosineSolver
+{
+    const Approximation * _approximation;
+    double * _eigenvalues[2];
+    gsl_fft_real_wavetable * _wavetables[2];
+    gsl_fft_real_workspace ** _workspaces;
+    unsigned _buffer_size;
+    double * _buffers;
+
+    CosineSolver ( const CosineSolver & other ) = delete;
+    CosineSolver & operator= ( const CosineSolver & other ) = delete;
+    bool operator== ( const CosineSolver & other ) const = delete;
+
+    void transform ( const unsigned & direction, double * values, const unsigned & stride, const unsigned & thread ) const;
+
+public:
+    // whole grids only, of at least two cells each way
+    CosineSolver ( const Approximation * approximation );
+    ~CosineSolver();
+
+    // b is the interior of field, overwritten by x; ghosts are left stale
+    void solve ( const double & c, Field * field ) const;
+};
+
+}
+
+#endif // PUREMETAL_COSINESOLVER_HPP
@@ -35,7 +35,7 @@ class CSPLinePostProcessor : public PostProcessor
     bool operator== ( const CSPLinePostProcessor & other ) const = delete;
 
 public:
-    inline CSPLinePostProcessor ( const double & r0, const std::string & path, const std::string & name, const bool & restart );
+    inline CSPLinePostProcessor ( const double & r0, const std::string & path, const std::string & name, const bool & restart, const bool & log_delt );
     ~CSPLinePostProcessor() = default;
 
     inline Interpolant * create_interpolant ( const double * x, const double * y, unsigned n ) override;
@@ -43,8 +43,8 @@ public:
 
 }
 
-PureMetal::CSPLinePostProcessor::CSPLinePostProcessor ( const double & r0, const std::string & path, const std::string & name, const bool & restart )
-    : PostProcessor ( r0, path, name, restart ) {}
+PureMetal::CSPLinePostProcessor::CSPLinePostProcessor ( const double & r0, const std::string & path, const std::string & name, const bool & restart, const bool & log_delt )
+    : PostProcessor ( r0, path, name, restart, log_delt ) {}
 
 PureMetal::Interpolant * PureMetal::CSPLinePostProcessor::create_interpolant ( const double * x, const double * y, unsigned int n )
 {
@@ -27,3 +27,29 @@ PureMetal::DatFile::DatFile ( const std::string & path, const std::string & name
     out.open ( _path + "/" + _name, append ? std::ios_base::app : std::ios_base::trunc );
     out.close();
 }
+
+void PureMetal::DatFile::add ( const unsigned int & ts, const double & time, const double & x, const double & v, const double & k1, const double & k2, const double & kpar )
+{
+    std::ofstream out;
+    out.open ( _path + "/" + _name, std::ios_base::app );
+    out << std::setprecision ( 16 ) << std::scientific << ts << " " << time << " " << x << " " << v << " " << k1 << " " << k2 << " " << kpar << std::endl;
+    out.close();
+}
+
+// with the delt of the timestep, for adaptive runs
+void PureMetal::DatFile::add ( const unsigned int & ts, const double & time, const double & x, const double & v, const double & k1, const double & k2, const double & kpar, const double & delt )
+{
+    std::ofstream out;
+    out.open ( _path + "/" + _name, std::ios_base::app );
+    out << std::setprecision ( 16 ) << std::scientific << ts << " " << time << " " << x << " " << v << " " << k1 << " " << k2 << " " << kpar << " " << delt << std::endl;
+    out.close();
+}
+
+// a single quantity over time, as the active fraction of narrow band runs
+void PureMetal::DatFile::add ( const unsigned int & ts, const double & time, const double & value )
+{
+    std::ofstream out;
+    out.open ( _path + "/" + _name, std::ios_base::app );
+    out << std::setprecision ( 16 ) << std::scientific << ts << " " << time << " " << value << std::endl;
+    out.close();
+}
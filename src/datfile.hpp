@@ -40,17 +40,11 @@ public:
     DatFile ( const std::string & path, const std::string & name, const bool & append );
     ~DatFile() = default;
 
-    inline void add ( const unsigned & ts, const double & time, const double & x, const double & v, const double & k1, const double & k2, const double & kpar );
+    void add ( const unsigned & ts, const double & time, const double & x, const double & v, const double & k1, const double & k2, const double & kpar );
+    void add ( const unsigned & ts, const double & time, const double & x, const double & v, const double & k1, const double & k2, const double & kpar, const double & delt );
+    void add ( const unsigned & ts, const double & time, const double & value );
 };
 
 }
 
-void PureMetal::DatFile::add ( const unsigned int & ts, const double & time, const double & x, const double & v, const double & k1, const double & k2, const double & kpar )
-{
-    std::ofstream out;
-    out.open ( _path + "/" + _name, std::ios_base::app );
-    out << std::setprecision ( 16 ) << std::scientific << ts << " " << time << " " << x << " " << v << " " << k1 << " " << k2 << " " << kpar << std::endl;
-    out.close();
-}
-
 #endif // PUREMETAL_DATFILE_HPP
@@ -0,0 +1,315 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "decomposition.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "boundary.hpp"
+#include "field.hpp"
+#include "messages.hpp"
+
+PureMetal::Decomposition::Decomposition ( int * argc, char *** argv )
+    : _rank ( 0 ),
+      _ranks ( 1 ),
+      _send ( nullptr ),
+      _receive ( nullptr )
+{
+    _dims[0] = _dims[1] = 1;
+    _coords[0] = _coords[1] = 0;
+    _neighbours[0] = _neighbours[1] = _neighbours[2] = _neighbours[3] = -1;
+    _global[0] = _global[1] = _size[0] = _size[1] = 0u;
+#ifdef PUREMETAL_MPI
+    // only the thread running main ever calls MPI, the pool threads just compute
+    int provided;
+    MPI_Init_thread ( argc, argv, MPI_THREAD_FUNNELED, &provided );
+    MPI_Comm_size ( MPI_COMM_WORLD, &_ranks );
+    _dims[0] = _dims[1] = 0;
+    MPI_Dims_create ( _ranks, 2, _dims );
+    const int periods[2] = { 0, 0 };
+    MPI_Cart_create ( MPI_COMM_WORLD, 2, _dims, periods, 0, &_comm );
+    MPI_Comm_rank ( _comm, &_rank );
+    MPI_Cart_coords ( _comm, _rank, 2, _coords );
+    MPI_Cart_shift ( _comm, 0, 1, _neighbours, _neighbours + 1 );
+    MPI_Cart_shift ( _comm, 1, 1, _neighbours + 2, _neighbours + 3 );
+    _pending = 0;
+#endif
+}
+
+PureMetal::Decomposition::~Decomposition()
+{
+    delete [] _receive;
+    delete [] _send;
+#ifdef PUREMETAL_MPI
+    MPI_Comm_free ( &_comm );
+    MPI_Finalize();
+#endif
+}
+
+int PureMetal::Decomposition::rank ( const int & px, const int & py ) const
+{
+    int rank = 0;
+#ifdef PUREMETAL_MPI
+    const int coords[2] = { px, py };
+    MPI_Cart_rank ( _comm, coords, &rank );
+#endif
+    return rank;
+}
+
+// every rank must keep at least two halos of interior cells per direction: the kernel computes the rows
+// a halo away from the edges while the ghost rows are in flight
+void PureMetal::Decomposition::split ( const unsigned * global, unsigned * size, unsigned * offset )
+{
+    for ( unsigned d = 0u; d < 2u; ++d ) {
+        if ( global[d] / _dims[d] < 2u * PUREMETAL_HALO ) {
+            throw std::runtime_error ( decomposition_size_msg );
+        }
+        _global[d] = global[d];
+        block ( global[d], _dims[d], _coords[d], _size[d], offset[d] );
+        size[d] = _size[d];
+    }
+    // one halo of up to two fields on each side of a direction
+    const unsigned buffer = 4u * PUREMETAL_HALO * std::max ( _size[1], _size[0] + 2u * PUREMETAL_HALO );
+    delete [] _receive;
+    delete [] _send;
+    _send = new double[buffer];
+    _receive = new double[buffer];
+}
+
+int PureMetal::Decomposition::owner ( const unsigned & i, const unsigned & j ) const
+{
+    return rank ( part ( _global[0], _dims[0], i ), part ( _global[1], _dims[1], j ) );
+}
+
+// messages are tagged with the field and the side they leave from, the receiver expects the opposite side
+void PureMetal::Decomposition::exchange_columns ( Field * const * fields, const unsigned & n )
+{
+    const int Nx = _size[0], Ny = _size[1];
+    const int block = PUREMETAL_HALO * Ny;
+    for ( unsigned f = 0u; f < n; ++f ) {
+        const double * origin = fields[f]->data();
+        const int stride = fields[f]->stride();
+        for ( int s = 0; s < 2; ++s ) {
+            double * out = _send + ( 2 * f + s ) * block;
+            const int first = s ? Nx - PUREMETAL_HALO : 0;
+            for ( int j = 0; j < Ny; ++j ) {
+                for ( int k = 0; k < PUREMETAL_HALO; ++k ) {
+                    out[j * PUREMETAL_HALO + k] = origin[j * stride + first + k];
+                }
+            }
+        }
+    }
+#ifdef PUREMETAL_MPI
+    int pending = 0;
+    for ( unsigned f = 0u; f < n; ++f ) {
+        for ( int s = 0; s < 2; ++s ) {
+            MPI_Irecv ( _receive + ( 2 * f + s ) * block, block, MPI_DOUBLE, _neighbours[s], 4 * f + ( s ^ 1 ), _comm, _requests + pending++ );
+            MPI_Isend ( _send + ( 2 * f + s ) * block, block, MPI_DOUBLE, _neighbours[s], 4 * f + s, _comm, _requests + pending++ );
+        }
+    }
+    MPI_Waitall ( pending, _requests, MPI_STATUSES_IGNORE );
+#endif
+    for ( unsigned f = 0u; f < n; ++f ) {
+        double * origin = fields[f]->data();
+        const int stride = fields[f]->stride();
+        for ( int s = 0; s < 2; ++s ) {
+            const double * in = _receive + ( 2 * f + s ) * block;
+            const int first = s ? Nx : -PUREMETAL_HALO;
+            for ( int j = 0; j < Ny; ++j ) {
+                double * row = origin + j * stride;
+                if ( physical ( s ) ) {
+                    s ? ReflectingBoundary::fill_upper ( row, Nx, PUREMETAL_HALO ) : ReflectingBoundary::fill_lower ( row, Nx, PUREMETAL_HALO );
+                } else {
+                    std::copy ( in + j * PUREMETAL_HALO, in + ( j + 1 ) * PUREMETAL_HALO, row + first );
+                }
+            }
+        }
+    }
+}
+
+void PureMetal::Decomposition::start_rows ( Field * const * fields, const unsigned & n )
+{
+    const int Nx = _size[0], Ny = _size[1];
+    const int width = Nx + 2 * PUREMETAL_HALO, block = PUREMETAL_HALO * width;
+    for ( unsigned f = 0u; f < n; ++f ) {
+        const double * origin = fields[f]->data();
+        const int stride = fields[f]->stride();
+        for ( int s = 0; s < 2; ++s ) {
+            double * out = _send + ( 2 * f + s ) * block;
+            const int first = s ? Ny - PUREMETAL_HALO : 0;
+            for ( int k = 0; k < PUREMETAL_HALO; ++k ) {
+                const double * row = origin + ( first + k ) * stride - PUREMETAL_HALO;
+                std::copy ( row, row + width, out + k * width );
+            }
+        }
+    }
+#ifdef PUREMETAL_MPI
+    _pending = 0;
+    for ( unsigned f = 0u; f < n; ++f ) {
+        for ( int s = 0; s < 2; ++s ) {
+            MPI_Irecv ( _receive + ( 2 * f + s ) * block, block, MPI_DOUBLE, _neighbours[2 + s], 4 * f + 2 + ( s ^ 1 ), _comm, _requests + _pending++ );
+            MPI_Isend ( _send + ( 2 * f + s ) * block, block, MPI_DOUBLE, _neighbours[2 + s], 4 * f + 2 + s, _comm, _requests + _pending++ );
+        }
+    }
+#endif
+}
+
+void PureMetal::Decomposition::finish_rows ( Field * const * fields, const unsigned & n )
+{
+    const int Nx = _size[0], Ny = _size[1];
+    const int width = Nx + 2 * PUREMETAL_HALO, block = PUREMETAL_HALO * width;
+#ifdef PUREMETAL_MPI
+    MPI_Waitall ( _pending, _requests, MPI_STATUSES_IGNORE );
+    _pending = 0;
+#endif
+    for ( unsigned f = 0u; f < n; ++f ) {
+        double * origin = fields[f]->data();
+        const int stride = fields[f]->stride();
+        for ( int s = 0; s < 2; ++s ) {
+            const double * in = _receive + ( 2 * f + s ) * block;
+            const int first = s ? Ny : -PUREMETAL_HALO;
+            for ( int k = 0; k < PUREMETAL_HALO; ++k ) {
+                const int j = first + k;
+                const double * row = physical ( 2 + s ) ? origin + ReflectingBoundary::index ( j, Ny ) * stride - PUREMETAL_HALO : in + k * width;
+                std::copy ( row, row + width, origin + j * stride - PUREMETAL_HALO );
+            }
+        }
+    }
+}
+
+void PureMetal::Decomposition::gather ( const Field * field, Field * global ) const
+{
+    const unsigned & Nx = _size[0], & Ny = _size[1];
+    double * local = new double[Nx * Ny];
+    for ( unsigned j = 0u; j < Ny; ++j ) {
+        std::copy ( field->data() + j * field->stride(), field->data() + j * field->stride() + Nx, local + j * Nx );
+    }
+#ifdef PUREMETAL_MPI
+    int * counts = nullptr, * displacements = nullptr;
+    double * blocks = nullptr;
+    if ( _rank == 0 ) {
+        counts = new int[_ranks];
+        displacements = new int[_ranks];
+        blocks = new double[_global[0] * _global[1]];
+        for ( int r = 0, displacement = 0; r < _ranks; displacement += counts[r++] ) {
+            int coords[2];
+            unsigned size[2], offset[2];
+            MPI_Cart_coords ( _comm, r, 2, coords );
+            block ( _global[0], _dims[0], coords[0], size[0], offset[0] );
+            block ( _global[1], _dims[1], coords[1], size[1], offset[1] );
+            counts[r] = size[0] * size[1];
+            displacements[r] = displacement;
+        }
+    }
+    MPI_Gatherv ( local, Nx * Ny, MPI_DOUBLE, blocks, counts, displacements, MPI_DOUBLE, 0, _comm );
+    if ( _rank == 0 ) {
+        for ( int r = 0; r < _ranks; ++r ) {
+            int coords[2];
+            unsigned size[2], offset[2];
+            MPI_Cart_coords ( _comm, r, 2, coords );
+            block ( _global[0], _dims[0], coords[0], size[0], offset[0] );
+            block ( _global[1], _dims[1], coords[1], size[1], offset[1] );
+            for ( unsigned j = 0u; j < size[1]; ++j ) {
+                const double * row = blocks + displacements[r] + j * size[0];
+                std::copy ( row, row + size[0], global->data() + ( offset[1] + j ) * global->stride() + offset[0] );
+            }
+        }
+        global->fill_boundary();
+    }
+    delete [] blocks;
+    delete [] displacements;
+    delete [] counts;
+#endif
+    delete [] local;
+}
+
+void PureMetal::Decomposition::scatter ( const Field * global, Field * field ) const
+{
+    const unsigned & Nx = _size[0], & Ny = _size[1];
+    double * local = new double[Nx * Ny];
+#ifdef PUREMETAL_MPI
+    int * counts = nullptr, * displacements = nullptr;
+    double * blocks = nullptr;
+    if ( _rank == 0 ) {
+        counts = new int[_ranks];
+        displacements = new int[_ranks];
+        blocks = new double[_global[0] * _global[1]];
+        for ( int r = 0, displacement = 0; r < _ranks; displacement += counts[r++] ) {
+            int coords[2];
+            unsigned size[2], offset[2];
+            MPI_Cart_coords ( _comm, r, 2, coords );
+            block ( _global[0], _dims[0], coords[0], size[0], offset[0] );
+            block ( _global[1], _dims[1], coords[1], size[1], offset[1] );
+            counts[r] = size[0] * size[1];
+            displacements[r] = displacement;
+            for ( unsigned j = 0u; j < size[1]; ++j ) {
+                const double * row = global->data() + ( offset[1] + j ) * global->stride() + offset[0];
+                std::copy ( row, row + size[0], blocks + displacement + j * size[0] );
+            }
+        }
+    }
+    MPI_Scatterv ( blocks, counts, displacements, MPI_DOUBLE, local, Nx * Ny, MPI_DOUBLE, 0, _comm );
+    delete [] blocks;
+    delete [] displacements;
+    delete [] counts;
+#endif
+    for ( unsigned j = 0u; j < Ny; ++j ) {
+        std::copy ( local + j * Nx, local + ( j + 1u ) * Nx, field->data() + j * field->stride() );
+    }
+    delete [] local;
+    field->fill_boundary();
+}
+
+bool PureMetal::Decomposition::all ( const bool & value ) const
+{
+    int result = value;
+#ifdef PUREMETAL_MPI
+    MPI_Allreduce ( MPI_IN_PLACE, &result, 1, MPI_INT, MPI_LAND, _comm );
+#endif
+    return result;
+}
+
+void PureMetal::Decomposition::min ( unsigned * values, const unsigned & n ) const
+{
+#ifdef PUREMETAL_MPI
+    MPI_Allreduce ( MPI_IN_PLACE, values, n, MPI_UNSIGNED, MPI_MIN, _comm );
+#endif
+}
+
+void PureMetal::Decomposition::max ( double * values, const unsigned & n ) const
+{
+#ifdef PUREMETAL_MPI
+    MPI_Allreduce ( MPI_IN_PLACE, values, n, MPI_DOUBLE, MPI_MAX, _comm );
+#endif
+}
+
+void PureMetal::Decomposition::sum ( double * values, const unsigned & n, const int & root ) const
+{
+#ifdef PUREMETAL_MPI
+    MPI_Reduce ( _rank == root ? MPI_IN_PLACE : values, values, n, MPI_DOUBLE, MPI_SUM, root, _comm );
+#endif
+}
+
+void PureMetal::Decomposition::broadcast ( double * values, const unsigned & n, const int & root ) const
+{
+#ifdef PUREMETAL_MPI
+    MPI_Bcast ( values, n, MPI_DOUBLE, root, _comm );
+#endif
+}
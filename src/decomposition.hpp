@@ -0,0 +1,121 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PUREMETAL_DECOMPOSITION_HPP
+#define PUREMETAL_DECOMPOSITION_HPP
+
+#ifdef PUREMETAL_MPI
+#include <mpi.h>
+#endif
+
+namespace PureMetal
+{
+
+class Field;
+
+// 2-D block decomposition of the grid over the MPI ranks: rank ( px, py ) owns a block of the
+// global grid and exchanges ghost layers with its four neighbours. Sides are numbered
+// 0 ( -x ), 1 ( +x ), 2 ( -y ) and 3 ( +y ); sides without a neighbour are physical boundaries.
+// Without PUREMETAL_MPI there is a single rank and approximations are never decomposed.
+class Decomposition
+{
+    int _rank;
+    int _ranks;
+    int _dims[2];
+    int _coords[2];
+    int _neighbours[4];
+    unsigned _global[2];
+    unsigned _size[2];
+    double * _send;
+    double * _receive;
+#ifdef PUREMETAL_MPI
+    MPI_Comm _comm;
+    MPI_Request _requests[16];
+    int _pending;
+#endif
+
+    Decomposition ( const Decomposition & other ) = delete;
+    Decomposition & operator= ( const Decomposition & other ) = delete;
+    bool operator== ( const Decomposition & other ) const = delete;
+
+    inline static void block ( const unsigned & n, const int & parts, const int & part, unsigned & size, unsigned & offset );
+    inline static int part ( const unsigned & n, const int & parts, const unsigned & k );
+    int rank ( const int & px, const int & py ) const;
+
+public:
+    Decomposition ( int * argc, char *** argv );
+    ~Decomposition();
+
+    inline const int & rank() const;
+    inline const int & ranks() const;
+    inline bool physical ( const unsigned & side ) const;
+
+    // local size and offset of this rank's block of a global grid, whose size must be the same for every call
+    void split ( const unsigned * global, unsigned * size, unsigned * offset );
+    int owner ( const unsigned & i, const unsigned & j ) const;
+
+    // ghost layers of up to two fields: columns first, since the rows carry the corners to the diagonal
+    // neighbours; start_rows returns as soon as the rows are posted so that interior rows can be computed
+    // meanwhile. Ghosts on physical sides are reflected
+    void exchange_columns ( Field * const * fields, const unsigned & n );
+    void start_rows ( Field * const * fields, const unsigned & n );
+    void finish_rows ( Field * const * fields, const unsigned & n );
+
+    // whole fields on rank 0, where global is a field of the undecomposed grid ( nullptr elsewhere )
+    void gather ( const Field * field, Field * global ) const;
+    void scatter ( const Field * global, Field * field ) const;
+
+    bool all ( const bool & value ) const;
+    void min ( unsigned * values, const unsigned & n ) const;
+    void max ( double * values, const unsigned & n ) const;
+    void sum ( double * values, const unsigned & n, const int & root ) const;
+    void broadcast ( double * values, const unsigned & n, const int & root ) const;
+};
+
+}
+
+void PureMetal::Decomposition::block ( const unsigned & n, const int & parts, const int & part, unsigned & size, unsigned & offset )
+{
+    const unsigned q = n / parts, r = n % parts, p = part;
+    size = q + ( p < r ? 1u : 0u );
+    offset = p * q + ( p < r ? p : r );
+}
+
+int PureMetal::Decomposition::part ( const unsigned & n, const int & parts, const unsigned & k )
+{
+    const unsigned q = n / parts, r = n % parts;
+    return k < r * ( q + 1u ) ? k / ( q + 1u ) : r + ( k - r * ( q + 1u ) ) / q;
+}
+
+const int & PureMetal::Decomposition::rank() const
+{
+    return _rank;
+}
+
+const int & PureMetal::Decomposition::ranks() const
+{
+    return _ranks;
+}
+
+bool PureMetal::Decomposition::physical ( const unsigned & side ) const
+{
+    return _neighbours[side] < 0;
+}
+
+#endif // PUREMETAL_DECOMPOSITION_HPP
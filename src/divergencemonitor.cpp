@@ -0,0 +1,116 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "divergencemonitor.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "approximation.hpp"
+#include "decomposition.hpp"
+#include "field.hpp"
+
+// partials hold the max | du | of each thread, rows the energy of each row: it is summed in row order so that
+// it does not depend on the threads the rows went to
+PureMetal::DivergenceMonitor::DivergenceMonitor ( const Approximation * approximation, const double & growth, const unsigned & window )
+    : _approximation ( approximation ),
+      _growth ( growth ),
+      _window ( window ),
+      _partials ( new double[approximation->threads()] ),
+      _rows ( nullptr ),
+      _rows_size ( 0u ),
+      _energy ( 0. ),
+      _change ( 0. ),
+      _rate ( 1. ),
+      _growing ( 0u ),
+      _timestep ( 0u )
+{
+}
+
+PureMetal::DivergenceMonitor::~DivergenceMonitor()
+{
+    delete [] _rows;
+    delete [] _partials;
+}
+
+// pairs of neighbours across ranks are left out
+bool PureMetal::DivergenceMonitor::update ( const Field * u0_field, const Field * u_field, const unsigned & steps, const unsigned & timestep )
+{
+    const unsigned & Nx = _approximation->size ( 0 );
+    const unsigned & Ny = _approximation->size ( 1 );
+    const double * u0 = u0_field->data(), * u = u_field->data();
+    const unsigned & stride0 = u0_field->stride(), & stride = u_field->stride();
+    // the grid may have grown since the last update
+    if ( _rows_size != Ny ) {
+        delete [] _rows;
+        _rows = new double[Ny];
+        _rows_size = Ny;
+    }
+    std::fill ( _partials, _partials + _approximation->threads(), 0. );
+    _approximation->parallel_tiles ( Ny, [ & ] ( const unsigned & j0, const unsigned & j1, const unsigned & thread ) {
+        double change = 0.;
+        for ( unsigned j = j0; j < j1; ++j ) {
+            const double * u0_row = u0 + j * stride0, * u_row = u + j * stride;
+            double energy = 0.;
+            // octant quadrants only keep the cells above the diagonal, and those next to it, up to date
+            for ( unsigned i = 0u; i < ( _approximation->octant() ? std::min ( Nx, j + 1u ) : Nx ); ++i ) {
+                const double du = u_row[i] - u0_row[i];
+                change = std::max ( change, std::abs ( du ) );
+                if ( i + 1u < Nx ) {
+                    const double dx = u_row[i + 1u] - u0_row[i + 1u] - du;
+                    energy += dx * dx;
+                }
+                if ( j + 1u < Ny ) {
+                    const double dy = u_row[i + stride] - u0_row[i + stride0] - du;
+                    energy += dy * dy;
+                }
+            }
+            _rows[j] = energy;
+        }
+        _partials[thread] = std::max ( _partials[thread], change );
+    } );
+    double energy = 0., change = 0.;
+    for ( unsigned j = 0u; j < Ny; ++j ) {
+        energy += _rows[j];
+    }
+    for ( unsigned thread = 0u; thread < _approximation->threads(); ++thread ) {
+        change = std::max ( change, _partials[thread] );
+    }
+    return update ( energy, change, steps, timestep );
+}
+
+// every rank sees the global energy and max | du |
+bool PureMetal::DivergenceMonitor::update ( double energy, double change, const unsigned & steps, const unsigned & timestep )
+{
+    if ( Decomposition * decomposition = _approximation->decomposition() ) {
+        decomposition->sum ( &energy, 1u, 0 );
+        decomposition->broadcast ( &energy, 1u, 0 );
+        decomposition->max ( &change, 1u );
+    }
+    // per timestep, as a call may cover several of them
+    _rate = _energy > 0. ? std::pow ( energy / _energy, 1. / steps ) : 1.;
+    _growing = _rate > _growth ? _growing + steps : 0u;
+    _energy = energy;
+    _change = change;
+    if ( !_timestep && _growing >= _window ) {
+        _timestep = timestep;
+    }
+    return !_timestep;
+}
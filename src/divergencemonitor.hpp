@@ -0,0 +1,99 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef PUREMETAL_DIVERGENCEMONITOR_HPP
+#define PUREMETAL_DIVERGENCEMONITOR_HPP
+
+namespace PureMetal
+{
+
+class Approximation;
+class Field;
+
+// watches the change du = u - u0 of each call to Simulation::next for the checkerboard noise of an
+// unstable delt: its high frequency energy, the sum of the squared differences of du between neighbours,
+// decays or grows slowly in a stable run and grows geometrically in an unstable one. Divergence is declared
+// once the energy has grown by more than growth per timestep for window consecutive timesteps. Kernels
+// that can sum the energy while stepping hand it over ( see Kernel::divergence ), sparing a sweep of u
+class DivergenceMonitor
+{
+    const Approximation * _approximation;
+    const double _growth;
+    const unsigned _window;
+    double * _partials;
+    double * _rows;
+    unsigned _rows_size;
+    double _energy;
+    double _change;
+    double _rate;
+    unsigned _growing;
+    unsigned _timestep;
+
+    DivergenceMonitor ( const DivergenceMonitor & other ) = delete;
+    DivergenceMonitor & operator= ( const DivergenceMonitor & other ) = delete;
+    bool operator== ( const DivergenceMonitor & other ) const = delete;
+
+public:
+    DivergenceMonitor ( const Approximation * approximation, const double & growth, const unsigned & window );
+    ~DivergenceMonitor();
+
+    // u0 and u are steps timesteps apart, u being the state at timestep; returns false once diverged
+    bool update ( const Field * u0, const Field * u, const unsigned & steps, const unsigned & timestep );
+    // as update, given the energy and max | du | of this rank, as the kernel summed them stepping ( see Kernel::divergence )
+    bool update ( double energy, double change, const unsigned & steps, const unsigned & timestep );
+
+    inline bool diverged() const;
+    inline const unsigned & timestep() const;
+    inline const double & energy() const;
+    inline const double & change() const;
+    inline const double & rate() const;
+};
+
+}
+
+bool PureMetal::DivergenceMonitor::diverged() const
+{
+    return _timestep;
+}
+
+// of the update that declared divergence
+const unsigned & PureMetal::DivergenceMonitor::timestep() const
+{
+    return _timestep;
+}
+
+const double & PureMetal::DivergenceMonitor::energy() const
+{
+    return _energy;
+}
+
+// max | du | of the last update
+const double & PureMetal::DivergenceMonitor::change() const
+{
+    return _change;
+}
+
+// growth of the energy per timestep at the last update
+const double & PureMetal::DivergenceMonitor::rate() const
+{
+    return _rate;
+}
+
+#endif // PUREMETAL_DIVERGENCEMONITOR_HPP
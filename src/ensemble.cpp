@@ -0,0 +1,208 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "ensemble.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+#include "messages.hpp"
+#include "simulation.hpp"
+#include "specifications.hpp"
+#include "threadpool.hpp"
+
+// with several ranks, each one runs every ranks-th entry of the list
+PureMetal::Ensemble::Ensemble ( const std::string & list_file, const int & rank, const int & ranks )
+    : _members (),
+      _threads ( 1u )
+{
+    std::ifstream list ( list_file );
+    if ( !list ) {
+        throw std::runtime_error ( ensemble_list_error_msg + list_file );
+    }
+    unsigned entries = 0u;
+    std::string line;
+    try {
+        while ( std::getline ( list, line ) ) {
+            const std::size_t first = line.find_first_not_of ( " \t\r" );
+            if ( first == std::string::npos || line[first] == '#' ) {
+                continue;
+            }
+            const std::string input_file = line.substr ( first, line.find_last_not_of ( " \t\r" ) + 1u - first );
+            if ( static_cast<int> ( entries++ % ranks ) != rank ) {
+                continue;
+            }
+            Specifications * specs = new Specifications ( input_file );
+            _members.push_back ( Member { input_file, specs, nullptr, State::pending, specs->delt_max(), specs->delt_min(), specs->delt_max() } );
+            _threads = std::max ( _threads, specs->threads() );
+        }
+    } catch ( ... ) {
+        for ( Member & member : _members ) {
+            delete member.specs;
+        }
+        throw;
+    }
+    if ( !entries ) {
+        throw std::runtime_error ( ensemble_empty_msg + list_file );
+    }
+}
+
+PureMetal::Ensemble::~Ensemble()
+{
+    for ( Member & member : _members ) {
+        delete member.simulation;
+        delete member.specs;
+    }
+}
+
+// as the single run driver, without restarts and precision reports; progress is only reported per run
+void PureMetal::Ensemble::start ( Member & member, ThreadPool * pool, std::ostream & os )
+{
+    const Specifications * specs = member.specs;
+    if ( specs->time_type() == TimeType::stable && ! ( member.delt > specs->delt_min() ) ) {
+        member.state = State::finished;
+        return;
+    }
+    member.simulation = new Simulation ( specs, pool, nullptr );
+    member.state = State::running;
+    switch ( specs->time_type() ) {
+    case TimeType::fixed:
+        member.simulation->start ( specs->delt(), 1u + static_cast<unsigned> ( specs->max_time() / specs->delt() ) );
+        member.simulation->save();
+        break;
+    case TimeType::stable:
+        ensemble_delt_info ( os, member.input_file, member.delt );
+        member.simulation->start ( member.delt, specs->max_timestep() );
+        if ( specs->out_interval() ) {
+            member.simulation->save();
+        }
+        break;
+    case TimeType::steady_state:
+        member.simulation->start ( specs->delt(), specs->steady_state_threshold(), specs->window_size() );
+        member.simulation->save();
+        break;
+    case TimeType::adaptive:
+        member.simulation->start ( specs->delt(), specs->max_time() );
+        member.simulation->save();
+        break;
+    default:
+        break;
+    }
+}
+
+// runs on any thread of the pool: no output but the simulation's own files
+void PureMetal::Ensemble::advance ( Member & member ) const
+{
+    Simulation * simulation = member.simulation;
+    const bool check = member.specs->stability_check() || member.specs->time_type() == TimeType::stable;
+    for ( unsigned n = 0u; n < slice; ++n ) {
+        if ( !simulation->next() ) {
+            member.state = State::finished;
+            return;
+        }
+        if ( check && !simulation->stable() ) {
+            member.state = State::unstable;
+            return;
+        }
+        if ( simulation->save_timestep() ) {
+            simulation->save();
+        }
+    }
+}
+
+// releases the simulation of a run that stopped, unstable stable runs try again with a smaller delt
+// and bisection ones with the middle of their bracket until it is narrower than delt_tolerance
+void PureMetal::Ensemble::finish ( Member & member, ThreadPool * pool, std::ostream & os )
+{
+    const Specifications * specs = member.specs;
+    Simulation * simulation = member.simulation;
+    if ( member.state == State::unstable ) {
+        ensemble_unstable_info ( os, member.input_file, simulation->time() );
+    } else {
+        ensemble_finished_info ( os, member.input_file, simulation->time() );
+        if ( specs->time_type() == TimeType::steady_state ) {
+            os << std::defaultfloat << std::setprecision ( 6 );
+            steady_state_progress_info ( os, true, simulation->time(), simulation->mean_v0(), simulation->mean_k10(), simulation->mean_k20(), simulation->mean_kpar0() );
+        }
+    }
+    delete member.simulation;
+    member.simulation = nullptr;
+    if ( specs->time_type() == TimeType::stable && specs->search() == SearchType::bisection ) {
+        // one candidate at a time, the runs of the ensemble keep the threads busy
+        ( member.state == State::unstable ? member.upper : member.lower ) = member.delt;
+        if ( member.upper - member.lower > specs->delt_tolerance() ) {
+            member.delt = .5 * ( member.lower + member.upper );
+            start ( member, pool, os );
+        } else if ( member.lower > specs->delt_min() ) {
+            ensemble_stable_delt_info ( os, member.input_file, member.lower, member.upper - member.lower );
+        }
+    } else if ( member.state == State::unstable && specs->time_type() == TimeType::stable ) {
+        if ( specs->delt_muptiplier() ) {
+            member.delt *= specs->delt_muptiplier();
+        } else {
+            member.delt -= specs->delt_step();
+        }
+        start ( member, pool, os );
+    }
+}
+
+// returns false if any fixed or steady state run turned unstable
+bool PureMetal::Ensemble::run ( ThreadPool * pool, std::ostream & os )
+{
+    // twice as many live runs as threads leave the scheduler room to balance runs of different cost
+    const unsigned live_limit = 2u * pool->size();
+    bool stable = true;
+    std::vector<Member *> live;
+    while ( true ) {
+        live.clear();
+        for ( Member & member : _members ) {
+            if ( member.state == State::pending && live.size() < live_limit ) {
+                start ( member, pool, os );
+            }
+            if ( member.state == State::running ) {
+                live.push_back ( &member );
+            }
+        }
+        if ( live.empty() ) {
+            break;
+        }
+        if ( live.size() >= pool->size() ) {
+            // each run is stepped by one thread at a time, its own sweeps run serially
+            pool->parallel_tiles ( live.size(), [ & ] ( const unsigned & k0, const unsigned & k1, const unsigned & ) {
+                for ( unsigned k = k0; k < k1; ++k ) {
+                    advance ( *live[k] );
+                }
+            } );
+        } else {
+            for ( Member * member : live ) {
+                advance ( *member );
+            }
+        }
+        for ( Member * member : live ) {
+            if ( member->state != State::running ) {
+                stable = stable && ( member->state != State::unstable || member->specs->time_type() == TimeType::stable );
+                finish ( *member, pool, os );
+            }
+        }
+    }
+    return stable;
+}
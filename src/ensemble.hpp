@@ -0,0 +1,84 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef PUREMETAL_ENSEMBLE_HPP
+#define PUREMETAL_ENSEMBLE_HPP
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace PureMetal
+{
+
+class Simulation;
+class Specifications;
+class ThreadPool;
+
+// runs the specifications listed in a file, one path per line, as simulations sharing one thread pool:
+// while there are at least as many live runs as threads each thread advances whole runs, stealing them
+// from the busy threads, and once runs have finished the remaining ones are advanced with the full pool
+class Ensemble
+{
+    enum class State {
+        pending, running, finished, unstable
+    };
+
+    struct Member {
+        std::string input_file;
+        Specifications * specs;
+        Simulation * simulation;
+        State state;
+        double delt; // of the current attempt of stable runs
+        double lower; // bracket of bisection stable runs
+        double upper;
+    };
+
+    std::vector<Member> _members;
+    unsigned _threads;
+
+    Ensemble ( const Ensemble & other ) = delete;
+    Ensemble & operator= ( const Ensemble & other ) = delete;
+    bool operator== ( const Ensemble & other ) const = delete;
+
+    void start ( Member & member, ThreadPool * pool, std::ostream & os );
+    void advance ( Member & member ) const;
+    void finish ( Member & member, ThreadPool * pool, std::ostream & os );
+
+public:
+    Ensemble ( const std::string & list_file, const int & rank, const int & ranks );
+    ~Ensemble();
+
+    inline const unsigned & threads() const;
+
+    bool run ( ThreadPool * pool, std::ostream & os );
+
+    // calls to Simulation::next each live run makes per round before the runs are rebalanced
+    static const unsigned slice = 10u;
+};
+
+}
+
+const unsigned & PureMetal::Ensemble::threads() const
+{
+    return _threads;
+}
+
+#endif // PUREMETAL_ENSEMBLE_HPP
@@ -19,42 +19,124 @@
 
 #include "field.hpp"
 
+#include <algorithm>
+#include <utility>
+
+#include "boundary.hpp"
+#include "decomposition.hpp"
+
 PureMetal::Field::Field ( const PureMetal::Approximation * approximation, const double & value )
     :    _approximation ( approximation ),
-         _values ( nullptr )
+         _stride ( _approximation->size ( 0 ) + 2 * PUREMETAL_HALO ),
+         _values ( nullptr ),
+         _origin ( nullptr )
 {
-    unsigned size = _approximation->size ( 0 ) * _approximation->size ( 1 );
+    unsigned size = _stride * ( _approximation->size ( 1 ) + 2 * PUREMETAL_HALO );
     _values = new double[size];
+    _origin = _values + PUREMETAL_HALO * _stride + PUREMETAL_HALO;
     for ( unsigned i = 0u; i < size; ++i ) {
         _values[i] = value;
     }
 }
 
-void PureMetal::Field::update ( const std::function< double ( const unsigned &, const unsigned & ) > & function )
+// ghost layers are copied/added as well so that they stay consistent; rows may be strided differently
+void PureMetal::Field::copy_field ( const PureMetal::Field * field )
 {
-    const unsigned & Nx = _approximation->size ( 0 );
-    const unsigned & Ny = _approximation->size ( 1 );
-    for ( unsigned j = 0u; j < Ny; ++j )
-        for ( unsigned i = 0u; i < Nx; ++i ) {
-            _values[ j * Nx + i] =  function ( i, j );
+    const int width = _approximation->size ( 0 ) + 2 * PUREMETAL_HALO;
+    _approximation->parallel_for ( _approximation->size ( 1 ) + 2 * PUREMETAL_HALO, [ & ] ( const unsigned & j0, const unsigned & j1, const unsigned & ) {
+        for ( int j = static_cast<int> ( j0 ) - PUREMETAL_HALO; j < static_cast<int> ( j1 ) - PUREMETAL_HALO; ++j ) {
+            double * row = _origin + j * static_cast<int> ( _stride ) - PUREMETAL_HALO;
+            const double * src = field->_origin + j * static_cast<int> ( field->_stride ) - PUREMETAL_HALO;
+            for ( int k = 0; k < width; ++k ) {
+                row[k] = src[k];
+            }
         }
+    } );
 }
 
-void PureMetal::Field::copy_field ( const PureMetal::Field * field )
+void PureMetal::Field::add_field ( const PureMetal::Field * field )
+{
+    const int width = _approximation->size ( 0 ) + 2 * PUREMETAL_HALO;
+    _approximation->parallel_for ( _approximation->size ( 1 ) + 2 * PUREMETAL_HALO, [ & ] ( const unsigned & j0, const unsigned & j1, const unsigned & ) {
+        for ( int j = static_cast<int> ( j0 ) - PUREMETAL_HALO; j < static_cast<int> ( j1 ) - PUREMETAL_HALO; ++j ) {
+            double * row = _origin + j * static_cast<int> ( _stride ) - PUREMETAL_HALO;
+            const double * src = field->_origin + j * static_cast<int> ( field->_stride ) - PUREMETAL_HALO;
+            for ( int k = 0; k < width; ++k ) {
+                row[k] += src[k];
+            }
+        }
+    } );
+}
+
+// moves the values cells columns towards i = 0, the last cells columns taking value; the ghosts are left stale
+void PureMetal::Field::shift ( const unsigned & cells, const double & value )
 {
     const unsigned & Nx = _approximation->size ( 0 );
-    const unsigned & Ny = _approximation->size ( 1 );
-    for ( unsigned k = 0u; k < Nx * Ny; ++k ) {
-        _values[ k ] =  field->_values[k];
-    }
+    _approximation->parallel_for ( _approximation->size ( 1 ), [ & ] ( const unsigned & j0, const unsigned & j1, const unsigned & ) {
+        for ( unsigned j = j0; j < j1; ++j ) {
+            double * row = _origin + j * _stride;
+            std::copy ( row + cells, row + Nx, row );
+            std::fill ( row + Nx - cells, row + Nx, value );
+        }
+    } );
 }
 
-void PureMetal::Field::add_field ( const PureMetal::Field * field )
+// copies field, nx x ny cells from its origin, into the cells it covers, the others taking value; the ghosts
+// are left stale
+void PureMetal::Field::extend ( const Field * field, const unsigned & nx, const unsigned & ny, const double & value )
 {
     const unsigned & Nx = _approximation->size ( 0 );
-    const unsigned & Ny = _approximation->size ( 1 );
-    for ( unsigned k = 0u; k < Nx * Ny; ++k ) {
-        _values[ k ] +=  field->_values[k];
+    _approximation->parallel_for ( _approximation->size ( 1 ), [ & ] ( const unsigned & j0, const unsigned & j1, const unsigned & ) {
+        for ( unsigned j = j0; j < j1; ++j ) {
+            double * row = _origin + j * _stride;
+            if ( j < ny ) {
+                const double * src = field->_origin + j * field->_stride;
+                std::copy ( src, src + nx, row );
+                std::fill ( row + nx, row + Nx, value );
+            } else {
+                std::fill ( row, row + Nx, value );
+            }
+        }
+    } );
+}
+
+// octant quadrants: the first cells of row j below the diagonal, j < i <= j + cells, take the values of their
+// images across it; the ghosts are left stale
+void PureMetal::Field::reflect_diagonal ( const unsigned & cells )
+{
+    const unsigned & N = _approximation->size ( 0 );
+    _approximation->parallel_for ( N, [ & ] ( const unsigned & j0, const unsigned & j1, const unsigned & ) {
+        for ( unsigned j = j0; j < j1; ++j ) {
+            double * row = _origin + j * _stride;
+            for ( unsigned i = j + 1u; i < std::min ( N, j + 1u + cells ); ++i ) {
+                row[i] = _origin[i * _stride + j];
+            }
+        }
+    } );
+}
+
+// reflecting boundary: the ghost value at -k (N-1+k) mirrors the interior value at k (N-1-k);
+// on decomposed grids the ghosts bordering other blocks come from the neighbouring ranks
+void PureMetal::Field::fill_boundary()
+{
+    if ( Decomposition * decomposition = _approximation->decomposition() ) {
+        Field * const fields[1] = { this };
+        decomposition->exchange_columns ( fields, 1u );
+        decomposition->start_rows ( fields, 1u );
+        decomposition->finish_rows ( fields, 1u );
+        return;
+    }
+    const int & Nx = _approximation->size ( 0 );
+    const int & Ny = _approximation->size ( 1 );
+    const int & s = _stride;
+    for ( int j = 0; j < Ny; ++j ) {
+        ReflectingBoundary::fill ( _origin + j * s, Nx, PUREMETAL_HALO );
+    }
+    for ( int k = 1; k <= PUREMETAL_HALO; ++k ) {
+        for ( const int & j : { -k, Ny - 1 + k } ) {
+            const double * src = _origin + ReflectingBoundary::index ( j, Ny ) * s - PUREMETAL_HALO;
+            std::copy ( src, src + Nx + 2 * PUREMETAL_HALO, _origin + j * s - PUREMETAL_HALO );
+        }
     }
 }
 
@@ -63,9 +145,12 @@ const double & PureMetal::Field::at ( int i, int j ) const
     const int & Nx = _approximation->size(0);
     const int & Ny = _approximation->size(1);
 
-    if ( i < 0 ) i = -i;
-    if ( j < 0 ) j = -j;
-    if ( i >= Nx ) i = 2 * Nx - i - 2;
-    if ( j >= Ny ) j = 2 * Ny - j - 2;
-    return ( *this ) ( i, j );
+    // indices past a neighbouring block read its ghosts, which reach PUREMETAL_HALO cells
+    if ( i < 0 && _approximation->physical ( 0u ) ) i = -i;
+    if ( j < 0 && _approximation->physical ( 2u ) ) j = -j;
+    if ( i >= Nx && _approximation->physical ( 1u ) ) i = 2 * Nx - i - 2;
+    if ( j >= Ny && _approximation->physical ( 3u ) ) j = 2 * Ny - j - 2;
+    // and those below the diagonal of octant quadrants their images above it
+    if ( i > j && _approximation->octant() ) std::swap ( i, j );
+    return _origin[ j * static_cast<int> ( _stride ) + i];
 }
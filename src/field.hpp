@@ -24,6 +24,14 @@
 
 #include "approximation.hpp"
 
+// width of the ghost layer surrounding the interior of every field; decomposed grids derive
+// the anisotropy of the cells next to a neighbouring block, which reaches two cells into it
+#ifdef PUREMETAL_MPI
+#define PUREMETAL_HALO 2
+#else
+#define PUREMETAL_HALO 1
+#endif
+
 namespace PureMetal
 {
 
@@ -35,19 +43,27 @@ class Field
 
 protected:
     const Approximation * _approximation;
+    unsigned _stride;
     double * _values;
+    double * _origin;
 
     Field ( const Approximation * approximation, const double & value );
     inline Field ( const Approximation * approximation, const std::function<double ( const unsigned &, const unsigned & ) > & function );
+    inline Field ( const Approximation * approximation, double * origin, const unsigned & stride );
 
 public:
     virtual inline ~Field();
 
     inline double * data() const;
+    inline const unsigned & stride() const;
 
-    void update ( const std::function<double ( const unsigned &, const unsigned & ) > & function );
+    template<class Function> inline void update ( const Function & function );
     void copy_field ( const Field * field );
     void add_field ( const Field * field );
+    void shift ( const unsigned & cells, const double & value );
+    void extend ( const Field * field, const unsigned & nx, const unsigned & ny, const double & value );
+    void reflect_diagonal ( const unsigned & cells );
+    void fill_boundary();
 
     inline const double & operator () ( const unsigned & i, const unsigned & j ) const;
     const double & at ( int i, int j ) const;
@@ -61,48 +77,82 @@ public:
 
 PureMetal::Field::Field ( const PureMetal::Approximation * approximation, const std::function< double ( const unsigned &, const unsigned & ) > & function )
     : _approximation ( approximation ),
-      _values ( nullptr )
+      _stride ( _approximation->size ( 0 ) + 2 * PUREMETAL_HALO ),
+      _values ( nullptr ),
+      _origin ( nullptr )
 {
-    unsigned size = _approximation->size ( 0 ) * _approximation->size ( 1 );
+    unsigned size = _stride * ( _approximation->size ( 1 ) + 2 * PUREMETAL_HALO );
     _values = new double[size];
+    _origin = _values + PUREMETAL_HALO * _stride + PUREMETAL_HALO;
     update ( function );
 }
 
+// view on values owned elsewhere ( see InterleavedField ), rows are stride apart
+PureMetal::Field::Field ( const PureMetal::Approximation * approximation, double * origin, const unsigned & stride )
+    : _approximation ( approximation ),
+      _stride ( stride ),
+      _values ( nullptr ),
+      _origin ( origin )
+{}
+
 PureMetal::Field::~Field()
 {
     delete [] _values;
     _values = nullptr;
+    _origin = nullptr;
 }
 
+// interior point (0,0); rows are stride() apart and framed by PUREMETAL_HALO ghost cells
 double * PureMetal::Field::data() const
 {
-    return _values;
+    return _origin;
+}
+
+const unsigned & PureMetal::Field::stride() const
+{
+    return _stride;
 }
 
 const double & PureMetal::Field::operator() ( const unsigned & i, const unsigned & j ) const
+{
+    return _origin[ j * _stride + i];
+}
+
+template<class Function>
+void PureMetal::Field::update ( const Function & function )
 {
     const unsigned & Nx = _approximation->size ( 0 );
-    return _values[ j * Nx + i];
+    _approximation->parallel_for ( _approximation->size ( 1 ), [ & ] ( const unsigned & j0, const unsigned & j1, const unsigned & ) {
+        for ( unsigned j = j0; j < j1; ++j )
+            for ( unsigned i = 0u; i < Nx; ++i ) {
+                _origin[ j * _stride + i] =  function ( i, j );
+            }
+    } );
+    fill_boundary();
 }
 
+// stencils read the ghost layer directly: it must be up to date (see fill_boundary)
 double PureMetal::Field::x ( const unsigned & i, const unsigned & j ) const
 {
     const double & hx = _approximation->spacing ( 0 );
-    return ( at ( i + 1, j ) - at ( i - 1, j ) ) / ( 2.*hx );
+    const double * v = _origin + j * _stride + i;
+    return ( v[1] - v[-1] ) / ( 2.*hx );
 }
 
 double PureMetal::Field::y ( const unsigned & i, const unsigned & j ) const
 {
     const double & hy = _approximation->spacing ( 1 );
-    return ( at ( i, j + 1 ) - at ( i, j - 1 ) ) / ( 2.*hy );
+    const double * v = _origin + j * _stride + i;
+    return ( v[_stride] - v[- static_cast<int> ( _stride )] ) / ( 2.*hy );
 }
 
 double PureMetal::Field::laplacian ( const unsigned & i, const unsigned & j ) const
 {
     const double & hx = _approximation->spacing ( 0 );
     const double & hy = _approximation->spacing ( 1 );
-    return ( at ( i + 1, j ) + at ( i - 1, j ) - 2 * at ( i, j ) ) / hx +
-           ( at ( i, j + 1 ) + at ( i, j - 1 ) - 2 * at ( i, j ) ) / hy;
+    const double * v = _origin + j * _stride + i;
+    return ( v[1] + v[-1] - 2 * v[0] ) / hx +
+           ( v[_stride] + v[- static_cast<int> ( _stride )] - 2 * v[0] ) / hy;
 }
 
 #endif // PUREMETAL_FIELD_HPP
@@ -28,7 +28,7 @@
 namespace PureMetal
 {
 
-class FullDomainApproximation : public Approximation
+class FullDomainApproximation final : public Approximation
 {
     FullDomainApproximation ( const FullDomainApproximation & other ) = delete;
     FullDomainApproximation & operator= ( const FullDomainApproximation & other ) = delete;
@@ -40,6 +40,7 @@ public:
 
     inline Field * create_field ( const double & value ) const override;
     inline Field * create_field ( const std::function<double ( unsigned, unsigned ) > & function ) const override;
+    inline Field * create_field ( double * origin, const unsigned & stride ) const override;
 
     inline ApproximationType type() const override;
 
@@ -71,6 +72,11 @@ PureMetal::Field * PureMetal::FullDomainApproximation::create_field ( const std:
     return new FullDomainField ( this, function );
 }
 
+PureMetal::Field * PureMetal::FullDomainApproximation::create_field ( double * origin, const unsigned & stride ) const
+{
+    return new FullDomainField ( this, origin, stride );
+}
+
 PureMetal::ApproximationType PureMetal::FullDomainApproximation::type() const
 {
     return ApproximationType::QuarterDomain;
@@ -78,22 +84,22 @@ PureMetal::ApproximationType PureMetal::FullDomainApproximation::type() const
 
 unsigned PureMetal::FullDomainApproximation::i ( const double & x ) const
 {
-    return static_cast<unsigned> ( x / _spacing[0] + _size[0] / 2. );
+    return static_cast<unsigned> ( x / _spacing[0] + _global_size[0] / 2. ) - _offset[0];
 }
 
 unsigned PureMetal::FullDomainApproximation::j ( const double & y ) const
 {
-    return static_cast<unsigned> ( y / _spacing[0] + _size[1] / 2. );
+    return static_cast<unsigned> ( y / _spacing[0] + _global_size[1] / 2. ) - _offset[1];
 }
 
 double PureMetal::FullDomainApproximation::x ( const unsigned & i ) const
 {
-    return _spacing[0] * ( i - static_cast<unsigned> ( _size[0] / 2. ) );
+    return _spacing[0] * ( i + _offset[0] - static_cast<unsigned> ( _global_size[0] / 2. ) );
 }
 
 double PureMetal::FullDomainApproximation::y ( const unsigned & j ) const
 {
-    return _spacing[1] * ( j - static_cast<unsigned> ( _size[1] / 2. ) );
+    return _spacing[1] * ( j + _offset[1] - static_cast<unsigned> ( _global_size[1] / 2. ) );
 }
 
 
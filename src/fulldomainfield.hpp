@@ -34,6 +34,7 @@ class FullDomainField : public Field
 public:
     inline FullDomainField ( const Approximation * approximation, const double & value );
     inline FullDomainField ( const Approximation * approximation, const std::function<double ( unsigned, unsigned ) > & function );
+    inline FullDomainField ( const Approximation * approximation, double * origin, const unsigned & stride );
     ~FullDomainField() = default;
 };
 
@@ -45,5 +46,8 @@ PureMetal::FullDomainField::FullDomainField ( const Approximation * approximatio
 PureMetal::FullDomainField::FullDomainField ( const PureMetal::Approximation * approximation, const std::function< double ( unsigned, unsigned ) > & function )
     : Field ( approximation, function ) {}
 
+PureMetal::FullDomainField::FullDomainField ( const PureMetal::Approximation * approximation, double * origin, const unsigned & stride )
+    : Field ( approximation, origin, stride ) {}
+
 
 #endif // PUREMETAL_FULLDOMAINFIELD_HPP
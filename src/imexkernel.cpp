@@ -0,0 +1,161 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "imexkernel.hpp"
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "approximation.hpp"
+#include "cosinesolver.hpp"
+#include "field.hpp"
+#include "messages.hpp"
+
+PureMetal::ImexKernel::ImexKernel ( Kernel * explicit_kernel, const Approximation * approximation, const double & alpha )
+    : _approximation ( approximation ),
+      _alpha ( alpha ),
+      _explicit ( explicit_kernel ),
+      _solver ( nullptr ),
+      _bounds ( nullptr )
+{
+    // transforms span whole rows and columns
+    if ( approximation->decomposition() ) {
+        delete explicit_kernel;
+        throw std::runtime_error ( imex_decomposition_msg );
+    }
+    _solver = new CosineSolver ( approximation );
+    _bounds = new double[2u * approximation->threads()];
+    // no step has written u yet, bounds() reports none until one does
+    for ( unsigned thread = 0u; thread < approximation->threads(); ++thread ) {
+        _bounds[2u * thread] = _bounds[2u * thread + 1u] = std::numeric_limits<double>::quiet_NaN();
+    }
+}
+
+PureMetal::ImexKernel::~ImexKernel()
+{
+    delete [] _bounds;
+    delete _solver;
+    delete _explicit;
+}
+
+unsigned PureMetal::ImexKernel::configure ( const unsigned & tile_rows, const unsigned & , const double & delt, Field * psi0, Field * u0, Field * psi, Field * u )
+{
+    return _explicit->configure ( tile_rows, 1u, delt, psi0, u0, psi, u );
+}
+
+// the ghosts of psi0 are those the last step filled, so its laplacian is taken as the explicit kernel takes it
+void PureMetal::ImexKernel::step ( const double & delt, const unsigned & , Field * psi0, Field * u0, Field * psi, Field * u )
+{
+    const unsigned & Nx = _approximation->size ( 0 );
+    const unsigned & Ny = _approximation->size ( 1 );
+    _explicit->step ( delt, 1u, psi0, u0, psi, u );
+    _approximation->parallel_tiles ( Ny, [ & ] ( const unsigned & j0, const unsigned & j1, const unsigned & ) {
+        for ( unsigned j = j0; j < j1; ++j ) {
+            double * p = psi->data() + j * psi->stride();
+            for ( unsigned i = 0u; i < Nx; ++i ) {
+                p[i] -= delt * psi0->laplacian ( i, j );
+            }
+        }
+    } );
+    _solver->solve ( delt, psi );
+    _approximation->parallel_tiles ( Ny, [ & ] ( const unsigned & j0, const unsigned & j1, const unsigned & ) {
+        for ( unsigned j = j0; j < j1; ++j ) {
+            const double * p = psi->data() + j * psi->stride(), * p0 = psi0->data() + j * psi0->stride(), * v0 = u0->data() + j * u0->stride();
+            double * v = u->data() + j * u->stride();
+            for ( unsigned i = 0u; i < Nx; ++i ) {
+                v[i] = v0[i] + ( p[i] - p0[i] ) / 2.;
+            }
+        }
+    } );
+    _solver->solve ( delt * _alpha, u );
+    // each thread keeps the bounds of the rows of u it scans, as min, max
+    for ( unsigned thread = 0u; thread < _approximation->threads(); ++thread ) {
+        _bounds[2u * thread] = std::numeric_limits<double>::infinity();
+        _bounds[2u * thread + 1u] = -std::numeric_limits<double>::infinity();
+    }
+    _approximation->parallel_tiles ( Ny, [ & ] ( const unsigned & j0, const unsigned & j1, const unsigned & thread ) {
+        double min = _bounds[2u * thread], max = _bounds[2u * thread + 1u];
+        for ( unsigned j = j0; j < j1; ++j ) {
+            const double * v = u->data() + j * u->stride();
+            for ( unsigned i = 0u; i < Nx; ++i ) {
+                min = v[i] < min ? v[i] : min;
+                max = v[i] > max ? v[i] : max;
+            }
+        }
+        _bounds[2u * thread] = min;
+        _bounds[2u * thread + 1u] = max;
+    } );
+    psi->fill_boundary();
+    u->fill_boundary();
+}
+
+bool PureMetal::ImexKernel::bounds ( double & min, double & max ) const
+{
+    min = _bounds[0];
+    max = _bounds[1];
+    for ( unsigned thread = 1u; thread < _approximation->threads(); ++thread ) {
+        min = _bounds[2u * thread] < min ? _bounds[2u * thread] : min;
+        max = _bounds[2u * thread + 1u] > max ? _bounds[2u * thread + 1u] : max;
+    }
+    return ! std::isnan ( min );
+}
+
+double PureMetal::ImexKernel::max_a2() const
+{
+    return _explicit->max_a2();
+}
+
+// the whole field is solved: Specifications keep narrow bands to the explicit scheme
+void PureMetal::ImexKernel::narrow_band ( const double & delta, const unsigned & margin, const unsigned & interval )
+{
+    _explicit->narrow_band ( delta, margin, interval );
+}
+
+double PureMetal::ImexKernel::active_fraction() const
+{
+    return _explicit->active_fraction();
+}
+
+void PureMetal::ImexKernel::invalidate()
+{
+    _explicit->invalidate();
+}
+
+// the solves rewrite u after the explicit step: the monitor sweeps it
+void PureMetal::ImexKernel::watch_divergence()
+{
+}
+
+bool PureMetal::ImexKernel::divergence ( double &, double & ) const
+{
+    return false;
+}
+
+// the solves start from the u of the explicit step
+bool PureMetal::ImexKernel::leave_u()
+{
+    return false;
+}
+
+void PureMetal::ImexKernel::derive ( const Field * psi, Field * psix, Field * psiy, Field * n2, Field * a, Field * a2, Field * bxy ) const
+{
+    _explicit->derive ( psi, psix, psiy, n2, a, a2, bxy );
+}
@@ -0,0 +1,69 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef PUREMETAL_IMEXKERNEL_HPP
+#define PUREMETAL_IMEXKERNEL_HPP
+
+#include "kernel.hpp"
+
+namespace PureMetal
+{
+
+class CosineSolver;
+
+// semi implicit Euler steps around an explicit kernel: the laplacians of psi, which has coefficient 1
+// once divided by a2, and of u, with coefficient alpha, are taken at the new timestep and the rest of
+// both equations at the old one. The explicit step gives psi0 + delt ( L psi0 + f ), from which
+// delt L psi0 is taken away before solving ( I - delt L ) psi; u then solves
+// ( I - delt alpha L ) u = u0 + ( psi - psi0 ) / 2. Diffusion no longer bounds delt
+class ImexKernel : public Kernel
+{
+    const Approximation * _approximation;
+    const double _alpha;
+    Kernel * _explicit;
+    CosineSolver * _solver;
+    double * _bounds;
+
+    ImexKernel ( const ImexKernel & other ) = delete;
+    ImexKernel & operator= ( const ImexKernel & other ) = delete;
+    bool operator== ( const ImexKernel & other ) const = delete;
+
+public:
+    // takes ownership of explicit_kernel; whole grids only
+    ImexKernel ( Kernel * explicit_kernel, const Approximation * approximation, const double & alpha );
+    ~ImexKernel();
+
+    // steps are never blocked: each needs the whole field solved before the next
+    unsigned configure ( const unsigned & tile_rows, const unsigned & depth, const double & delt, Field * psi0, Field * u0, Field * psi, Field * u ) override;
+    void step ( const double & delt, const unsigned & steps, Field * psi0, Field * u0, Field * psi, Field * u ) override;
+    bool bounds ( double & min, double & max ) const override;
+    double max_a2() const override;
+    void narrow_band ( const double & delta, const unsigned & margin, const unsigned & interval ) override;
+    double active_fraction() const override;
+    void invalidate() override;
+    void watch_divergence() override;
+    bool divergence ( double & energy, double & change ) const override;
+    bool leave_u() override;
+    void derive ( const Field * psi, Field * psix, Field * psiy, Field * n2, Field * a, Field * a2, Field * bxy ) const override;
+};
+
+}
+
+#endif // PUREMETAL_IMEXKERNEL_HPP
@@ -0,0 +1,46 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "interleavedfield.hpp"
+
+#include "field.hpp"
+
+PureMetal::InterleavedField::InterleavedField ( const Approximation * approximation, const unsigned & components, const double & value )
+    : _values ( nullptr ),
+      _components ()
+{
+    const unsigned width = approximation->size ( 0 ) + 2 * PUREMETAL_HALO;
+    const unsigned size = components * width * ( approximation->size ( 1 ) + 2 * PUREMETAL_HALO );
+    _values = new double[size];
+    for ( unsigned k = 0u; k < size; ++k ) {
+        _values[k] = value;
+    }
+    for ( unsigned c = 0u; c < components; ++c ) {
+        _components.push_back ( approximation->create_field ( _values + ( PUREMETAL_HALO * components + c ) * width + PUREMETAL_HALO, components * width ) );
+    }
+}
+
+PureMetal::InterleavedField::~InterleavedField()
+{
+    for ( Field * component : _components ) {
+        delete component;
+    }
+    _components.clear();
+    delete [] _values;
+}
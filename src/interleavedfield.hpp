@@ -0,0 +1,57 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PUREMETAL_INTERLEAVEDFIELD_HPP
+#define PUREMETAL_INTERLEAVEDFIELD_HPP
+
+#include <vector>
+
+namespace PureMetal
+{
+
+class Approximation;
+class Field;
+
+// fields of an approximation sharing one block row by row: row j of every component,
+// ghost cells included, follows row j of the previous one, so that a stencil over all
+// of them reads a single stream
+class InterleavedField
+{
+    double * _values;
+    std::vector<Field *> _components;
+
+    InterleavedField ( const InterleavedField & other ) = delete;
+    InterleavedField & operator= ( const InterleavedField & other ) = delete;
+    bool operator== ( const InterleavedField & other ) const = delete;
+
+public:
+    InterleavedField ( const Approximation * approximation, const unsigned & components, const double & value );
+    ~InterleavedField();
+
+    inline Field * component ( const unsigned & c ) const;
+};
+
+}
+
+PureMetal::Field * PureMetal::InterleavedField::component ( const unsigned & c ) const
+{
+    return _components[c];
+}
+
+#endif // PUREMETAL_INTERLEAVEDFIELD_HPP
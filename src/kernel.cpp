@@ -0,0 +1,70 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "kernel.hpp"
+
+#include <stdexcept>
+
+#include "messages.hpp"
+#include "specifications.hpp"
+#include "boundary.hpp"
+#include "stencilkernel.hpp"
+#include "fulldomainapproximation.hpp"
+#include "quarterdomainapproximation.hpp"
+
+namespace
+{
+
+template<class ApproximationT, class Cell>
+PureMetal::Kernel * new_kernel ( const ApproximationT * approximation, const Cell & cell, const double & alpha, const double & lambda )
+{
+    if ( approximation->spacing ( 0 ) == approximation->spacing ( 1 ) ) {
+        return new PureMetal::StencilKernel<ApproximationT, PureMetal::ReflectingBoundary, Cell, PureMetal::SquareSpacing> ( approximation, cell, alpha, lambda );
+    }
+    return new PureMetal::StencilKernel<ApproximationT, PureMetal::ReflectingBoundary, Cell, PureMetal::RectangularSpacing> ( approximation, cell, alpha, lambda );
+}
+
+template<class ApproximationT>
+PureMetal::Kernel * new_kernel ( const ApproximationT * approximation, const double & alpha, const double & lambda, const double & epsilon, const double & tolerance )
+{
+    if ( epsilon == 0. ) {
+        return new_kernel ( approximation, PureMetal::IsotropicCell ( tolerance ), alpha, lambda );
+    }
+    return new_kernel ( approximation, PureMetal::AnisotropicCell ( epsilon, tolerance ), alpha, lambda );
+}
+
+}
+
+PureMetal::Kernel * PureMetal::Kernel::New ( const SimulationType & simulation_type, const Approximation * approximation, const double & alpha, const double & lambda, const double & epsilon, const double & tolerance )
+{
+    switch ( simulation_type ) {
+    case SimulationType::full :
+        return new_kernel ( static_cast<const FullDomainApproximation *> ( approximation ), alpha, lambda, epsilon, tolerance );
+    case SimulationType::quadrant :
+        return new_kernel ( static_cast<const QuarterDomainApproximation *> ( approximation ), alpha, lambda, epsilon, tolerance );
+    // octant quadrants mirror their diagonal, which would cross the blocks of decomposed grids
+    case SimulationType::octant :
+        if ( approximation->decomposition() ) {
+            throw std::runtime_error ( octant_msg );
+        }
+        return new_kernel ( static_cast<const QuarterDomainApproximation *> ( approximation ), alpha, lambda, epsilon, tolerance );
+    default :
+        return nullptr;
+    };
+}
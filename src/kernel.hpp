@@ -0,0 +1,74 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PUREMETAL_KERNEL_HPP
+#define PUREMETAL_KERNEL_HPP
+
+namespace PureMetal
+{
+
+enum class SimulationType;
+
+class Approximation;
+class Field;
+
+class Kernel
+{
+    Kernel ( const Kernel & other ) = delete;
+    Kernel & operator= ( const Kernel & other ) = delete;
+    bool operator== ( const Kernel & other ) const = delete;
+
+protected:
+    Kernel() = default;
+
+public:
+    virtual ~Kernel() = default;
+
+    static Kernel * New ( const SimulationType & simulation_type, const Approximation * approximation, const double & alpha, const double & lambda, const double & epsilon, const double & tolerance );
+
+    // tiling for blocked steps: tile rows and depth of 0 are tuned on psi0 and u0, overwriting psi and u; returns the depth
+    virtual unsigned configure ( const unsigned & tile_rows, const unsigned & depth, const double & delt, Field * psi0, Field * u0, Field * psi, Field * u ) = 0;
+    // advances psi0 and u0 by steps ( at most the configured depth ) timesteps into psi and u;
+    // on decomposed grids it refreshes the ghosts of psi0 and u0 first and leaves those of psi and u stale
+    virtual void step ( const double & delt, const unsigned & steps, Field * psi0, Field * u0, Field * psi, Field * u ) = 0;
+    // smallest and largest u the last step wrote, NaN left out; false before the first step, which has
+    // written none yet
+    virtual bool bounds ( double & min, double & max ) const = 0;
+    // largest a2 the last step took its increments with, 1 for isotropic cells
+    virtual double max_a2() const = 0;
+    // narrow band ( see StencilKernel ): cells far from the interface keep psi and only diffuse u
+    virtual void narrow_band ( const double & delta, const unsigned & margin, const unsigned & interval ) = 0;
+    // fraction of the cells the last step stepped in full, 1 without narrow band
+    virtual double active_fraction() const = 0;
+    // psi and u were changed other than by step ( see Simulation::shift_frame ): the next step scans them again
+    // for what it keeps track of between steps
+    virtual void invalidate() = 0;
+    // steps also sum the energy and max | du | of a DivergenceMonitor, while the rows of u are in cache
+    virtual void watch_divergence() = 0;
+    // those sums over the last step, false if the kernel leaves them to a sweep of the monitor
+    virtual bool divergence ( double & energy, double & change ) const = 0;
+    // steps only advance psi, from psi0 and u0, and leave u to the kernel wrapping this one
+    // ( see CoarseDiffusionKernel ); false if the kernel cannot step psi alone
+    virtual bool leave_u() = 0;
+    virtual void derive ( const Field * psi, Field * psix, Field * psiy, Field * n2, Field * a, Field * a2, Field * bxy ) const = 0;
+};
+
+}
+
+#endif // PUREMETAL_KERNEL_HPP
@@ -1,15 +1,27 @@
 #include <iostream>
 
+#include "decomposition.hpp"
+#include "ensemble.hpp"
 #include "options.hpp"
 #include "specifications.hpp"
 #include "messages.hpp"
 #include "simulation.hpp"
+#include "stablesearch.hpp"
 #include "postprocessor.hpp"
+#include "threadpool.hpp"
+#include "timestepcontroller.hpp"
+#include "precisionreport.hpp"
 
 using namespace PureMetal;
 
 int main ( int argc, char ** argv )
 {
+    // first, MPI may strip its own arguments
+    Decomposition * decomposition = new Decomposition ( &argc, &argv );
+    if ( decomposition->rank() != 0 ) {
+        std::cout.setstate ( std::ios_base::badbit );
+    }
+
     Options * options = nullptr;
     Specifications * specifications = nullptr;
 
@@ -20,9 +32,32 @@ int main ( int argc, char ** argv )
         usage ( std::cout );
         delete specifications;
         delete options;
+        delete decomposition;
         return 1;
     }
 
+    if ( options->ensemble() ) {
+        // ranks run different entries of the list and each one reports its own
+        std::cout.clear();
+        Ensemble * ensemble = nullptr;
+        try {
+            ensemble = new Ensemble ( options->input_file(), decomposition->rank(), decomposition->ranks() );
+        } catch ( const std::exception & e ) {
+            std::cerr << e.what() << std::endl;
+            parse_error ( std::cout, options->input_file() );
+            delete options;
+            delete decomposition;
+            return 1;
+        }
+        ThreadPool * pool = new ThreadPool ( ensemble->threads() );
+        const bool stable = ensemble->run ( pool, std::cout );
+        delete pool;
+        delete ensemble;
+        delete options;
+        delete decomposition;
+        return stable ? 0 : 1;
+    }
+
     try {
         specifications = new Specifications ( options->input_file() );
     } catch ( const std::exception & e ) {
@@ -30,13 +65,16 @@ int main ( int argc, char ** argv )
         parse_error ( std::cout, options->input_file() );
         delete specifications;
         delete options;
+        delete decomposition;
         return 1;
     }
 
+    ThreadPool * pool = new ThreadPool ( specifications->threads() );
+
     switch ( specifications->time_type() ) {
     case TimeType::fixed : {
         unsigned timesteps = 1u + static_cast<unsigned> ( specifications->max_time() / specifications->delt() );
-        Simulation simulation ( specifications );
+        Simulation simulation ( specifications, pool, decomposition );
         if ( options->restart() ) {
             try {
                 simulation.restart ( specifications->delt(), timesteps );
@@ -48,27 +86,54 @@ int main ( int argc, char ** argv )
             simulation.start ( specifications->delt(), timesteps );
             simulation.save();
         }
+        PrecisionReport * report = nullptr;
+        if ( specifications->precision_report() && !options->restart() ) {
+            report = new PrecisionReport ( specifications, pool, decomposition );
+            report->start ( specifications->delt(), timesteps );
+        }
 
         while ( simulation.next() ) {
             if ( specifications->stability_check() && !simulation.stable() ) {
+                divergence_info ( std::cout, simulation.monitor() );
                 stability_error ( std::cout );
+                delete report;
+                delete pool;
                 delete specifications;
                 delete options;
+                delete decomposition;
                 return 1;
             }
+            if ( report ) {
+                report->compare ( simulation );
+            }
             fixed_progress_info ( std::cout, simulation.progress() );
             if ( simulation.save_timestep() ) {
                 simulation.save();
             }
         }
+        if ( report ) {
+            report->save();
+            delete report;
+        }
     }
     break;
     case TimeType::stable: {
+        if ( specifications->search() == SearchType::bisection ) {
+            StableSearch search ( specifications, pool, decomposition );
+            if ( !search.run ( std::cout ) ) {
+                delete pool;
+                delete specifications;
+                delete options;
+                delete decomposition;
+                return 1;
+            }
+            break;
+        }
         double delt ( specifications->delt_max() );
         bool stable = true;
         while ( delt > specifications->delt_min() ) {
             stable_progress_info ( std::cout, delt );
-            Simulation simulation ( specifications );
+            Simulation simulation ( specifications, pool, decomposition );
             simulation.start ( delt, specifications->max_timestep() );
             if ( specifications->out_interval() ) {
                 simulation.save ( );
@@ -76,6 +141,7 @@ int main ( int argc, char ** argv )
 
             while ( simulation.next() ) {
                 if ( ! ( stable = simulation.stable() ) ) {
+                    divergence_info ( std::cout, simulation.monitor() );
                     stability_error ( std::cout );
                     break;
                 }
@@ -95,7 +161,7 @@ int main ( int argc, char ** argv )
     }
     break;
     case TimeType::steady_state: {
-        Simulation simulation ( specifications );
+        Simulation simulation ( specifications, pool, decomposition );
 
         if ( options->restart() ) {
             try {
@@ -108,28 +174,72 @@ int main ( int argc, char ** argv )
             simulation.start ( specifications->delt(), specifications->steady_state_threshold(), specifications->window_size() );
             simulation.save();
         }
+        PrecisionReport * report = nullptr;
+        if ( specifications->precision_report() && !options->restart() ) {
+            report = new PrecisionReport ( specifications, pool, decomposition );
+            report->start ( specifications->delt(), specifications->steady_state_threshold(), specifications->window_size() );
+        }
 
         while ( simulation.next() ) {
             if ( specifications->stability_check() && !simulation.stable() ) {
+                divergence_info ( std::cout, simulation.monitor() );
                 stability_error ( std::cout );
+                delete report;
+                delete pool;
                 delete specifications;
                 delete options;
+                delete decomposition;
                 return 1;
             }
+            if ( report ) {
+                report->compare ( simulation );
+            }
             steady_state_progress_info ( std::cout, simulation.steady_state_checkpoint(), simulation.time(), simulation.mean_v0(), simulation.mean_k10(), simulation.mean_k20(), simulation.mean_kpar0() );
             if ( simulation.save_timestep() ) {
                 simulation.save();
             }
         }
+        if ( report ) {
+            report->save();
+            delete report;
+        }
+    }
+    break;
+    case TimeType::adaptive: {
+        // adaptive runs always start from the initial state
+        if ( options->restart() ) {
+            restart_error ( std::cout );
+        }
+        Simulation simulation ( specifications, pool, decomposition );
+        simulation.start ( specifications->delt(), specifications->max_time() );
+        simulation.save();
+
+        while ( simulation.next() ) {
+            if ( specifications->stability_check() && !simulation.stable() ) {
+                divergence_info ( std::cout, simulation.monitor() );
+                stability_error ( std::cout );
+                delete pool;
+                delete specifications;
+                delete options;
+                delete decomposition;
+                return 1;
+            }
+            adaptive_progress_info ( std::cout, simulation.progress(), simulation.delt() );
+            if ( simulation.save_timestep() ) {
+                simulation.save();
+            }
+        }
+        adaptive_info ( std::cout, simulation.timestep(), simulation.controller()->rejected() );
     }
     break;
     default:
         break;
     }
 
-
+    delete pool;
     delete specifications;
     delete options;
+    delete decomposition;
 
     return 0;
 }
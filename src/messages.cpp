@@ -19,9 +19,17 @@
 
 #include "messages.hpp"
 
+#include "divergencemonitor.hpp"
+
 void PureMetal::usage ( std::ostream & os )
 {
     os << "Usage: pure_metal [--restart] <input>.xml" << std::endl;
+    os << "       pure_metal --ensemble <list of inputs>" << std::endl;
+}
+
+void PureMetal::benchmark_usage ( std::ostream & os )
+{
+    os << "Usage: pure_metal_bench [--warmup <n>] [--repeats <n>] [--sweeps <n>] [--grid <Nx>x<Ny>]... <input>.xml" << std::endl;
 }
 
 void PureMetal::parse_error ( std::ostream & os, const std::string & file )
@@ -38,3 +46,17 @@ void PureMetal::stability_error ( std::ostream & os )
 {
     os << "Simulation is unstable" << std::endl;
 }
+
+// only if the monitor caused the instability
+void PureMetal::divergence_info ( std::ostream & os, const DivergenceMonitor * monitor )
+{
+    if ( monitor && monitor->diverged() ) {
+        os << "Divergence at timestep " << monitor->timestep() << ": high frequency energy growing by ";
+        os << std::fixed << std::setprecision ( 4 ) << monitor->rate() << " per timestep" << std::endl;
+    }
+}
+
+void PureMetal::stable_search_error ( std::ostream & os )
+{
+    os << "No stable delt above delt_min" << std::endl;
+}
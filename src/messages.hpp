@@ -29,21 +29,55 @@
 namespace PureMetal
 {
 
+class DivergenceMonitor;
+
 const std::string options_number_error_msg = "Wrong number of options in input ";
 const std::string unknown_option_msg = "Unknown option: ";
+const std::string invalid_option_value_msg = "Invalid option value: ";
 const std::string unknown_symulation_type_msg = "Unknown SimulationComponent type: ";
 const std::string negative_upper_grid_msg = "Negative upper bound in grid: ";
 const std::string unknown_time_type_msg = "Unknown Time type: ";
+const std::string unknown_search_msg = "Unknown stable delt search: ";
+const std::string delt_tolerance_msg = "delt_tolerance must be positive";
+const std::string error_tolerance_msg = "error_tolerance must be positive";
+const std::string safety_msg = "safety must be in (0, 1]";
 const std::string unknown_save_label_msg = "Unknown save label: ";
+const std::string unknown_layout_msg = "Unknown Layout: ";
+const std::string unknown_scheme_msg = "Unknown Scheme: ";
+const std::string imex_decomposition_msg = "The imex Scheme needs the whole grid on one rank";
+const std::string narrow_band_msg = "NarrowBand needs delta in (0, 1) and a positive interval";
+const std::string narrow_band_imex_msg = "NarrowBand needs the explicit Scheme";
+const std::string octant_msg = "The octant SimulationComponent needs a square Grid, spaced alike along x and y, the explicit Scheme and one rank";
+const std::string moving_frame_msg = "MovingFrame needs a quadrant SimulationComponent, postprocess_polynomial or postprocess_cspline and an offset inside the Grid";
+const std::string growth_msg = "Growth needs a quadrant SimulationComponent, an initial grid within upper, a factor above 1 and a positive tolerance";
+const std::string coarse_diffusion_msg = "CoarseDiffusion needs a full or quadrant SimulationComponent, the explicit Scheme, a factor of 2 or 4, and neither Growth nor MovingFrame";
+const std::string coarse_grid_msg = "CoarseDiffusion needs the whole grid on one rank, with nodes every factor nodes from its centre to its edges";
+const std::string precision_report_postprocess_msg = "CoarseDiffusion validation needs postprocess_polynomial or postprocess_cspline";
+const std::string precision_report_time_msg = "CoarseDiffusion validation needs a fixed or steady_state Time type";
+const std::string decomposition_size_msg = "Grid too small for the number of ranks";
 const std::string output_dir_error_msg = "Cannot create output directory " ;
+const std::string ensemble_list_error_msg = "Unable to read ensemble list: ";
+const std::string ensemble_empty_msg = "No input files in ensemble list: ";
 
 void usage ( std::ostream & os );
+void benchmark_usage ( std::ostream & os );
 void parse_error ( std::ostream & os, const std::string & file );
 void restart_error ( std::ostream & os );
 void stability_error ( std::ostream & os );
+void stable_search_error ( std::ostream & os );
+void divergence_info ( std::ostream & os, const DivergenceMonitor * monitor );
 inline void fixed_progress_info ( std::ostream & os, const double & progress );
+inline void adaptive_progress_info ( std::ostream & os, const double & progress, const double & delt );
+inline void adaptive_info ( std::ostream & os, const unsigned & timesteps, const unsigned & rejected );
 inline void stable_progress_info ( std::ostream & os, const double & delt );
+inline void stable_cancelled_info ( std::ostream & os, const double & delt );
+inline void stable_rejected_info ( std::ostream & os, const double & delt, const unsigned & timestep );
+inline void stable_search_info ( std::ostream & os, const double & delt, const double & width, const unsigned & rounds, const unsigned & candidates, const unsigned long & timesteps );
 inline void steady_state_progress_info ( std::ostream & os, const bool & next_cell, const double & t, const double & v, const double & k1, const double & k2, const double & kpar );
+inline void ensemble_finished_info ( std::ostream & os, const std::string & file, const double & t );
+inline void ensemble_unstable_info ( std::ostream & os, const std::string & file, const double & t );
+inline void ensemble_delt_info ( std::ostream & os, const std::string & file, const double & delt );
+inline void ensemble_stable_delt_info ( std::ostream & os, const std::string & file, const double & delt, const double & width );
     
 }
 
@@ -54,12 +88,43 @@ inline void PureMetal::fixed_progress_info ( std::ostream & os, const double & p
     os << progress * 100. << "%" << std::endl;
 }
 
+inline void PureMetal::adaptive_progress_info ( std::ostream & os, const double & progress, const double & delt )
+{
+    os << std::setprecision ( 2 ) << std::fixed << "Progress: ";
+    os.width ( 6 );
+    os << progress * 100. << "%; delt: " << std::scientific << std::setprecision ( 5 ) << delt << std::endl;
+}
+
+inline void PureMetal::adaptive_info ( std::ostream & os, const unsigned & timesteps, const unsigned & rejected )
+{
+    os << "Timesteps: " << timesteps << "; rejected: " << rejected << std::endl;
+}
+
 inline void PureMetal::stable_progress_info ( std::ostream & os, const double & delt )
 {
     os << "Stability check for delt: ";
     os << std::scientific << std::setprecision ( 5 ) << delt << std::endl;
 }
 
+inline void PureMetal::stable_cancelled_info ( std::ostream & os, const double & delt )
+{
+    os << "Stability check cancelled for delt: ";
+    os << std::scientific << std::setprecision ( 5 ) << delt << std::endl;
+}
+
+inline void PureMetal::stable_rejected_info ( std::ostream & os, const double & delt, const unsigned & timestep )
+{
+    os << "Stability check rejected delt: ";
+    os << std::scientific << std::setprecision ( 5 ) << delt << " at timestep " << timestep << std::endl;
+}
+
+inline void PureMetal::stable_search_info ( std::ostream & os, const double & delt, const double & width, const unsigned & rounds, const unsigned & candidates, const unsigned long & timesteps )
+{
+    os << std::scientific << std::setprecision ( 5 );
+    os << "Stable delt: " << delt << "; bracket width: " << width << std::endl;
+    os << "Rounds: " << rounds << "; candidates: " << candidates << "; timesteps computed: " << timesteps << std::endl;
+}
+
 inline void PureMetal::steady_state_progress_info ( std::ostream & os, const bool & next_cell, const double & t, const double & v, const double & k1, const double & k2, const double & kpar )
 {
     if ( next_cell ) {
@@ -83,4 +148,24 @@ inline void PureMetal::steady_state_progress_info ( std::ostream & os, const boo
     }
 }
 
+inline void PureMetal::ensemble_finished_info ( std::ostream & os, const std::string & file, const double & t )
+{
+    os << file << ": finished at time " << std::setprecision ( 2 ) << std::fixed << t << std::endl;
+}
+
+inline void PureMetal::ensemble_unstable_info ( std::ostream & os, const std::string & file, const double & t )
+{
+    os << file << ": simulation is unstable at time " << std::setprecision ( 2 ) << std::fixed << t << std::endl;
+}
+
+inline void PureMetal::ensemble_delt_info ( std::ostream & os, const std::string & file, const double & delt )
+{
+    os << file << ": stability check for delt: " << std::scientific << std::setprecision ( 5 ) << delt << std::endl;
+}
+
+inline void PureMetal::ensemble_stable_delt_info ( std::ostream & os, const std::string & file, const double & delt, const double & width )
+{
+    os << file << ": stable delt: " << std::scientific << std::setprecision ( 5 ) << delt << "; bracket width: " << width << std::endl;
+}
+
 #endif // PUREMETAL_MESSAGES_HPP
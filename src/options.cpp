@@ -25,15 +25,17 @@
 
 PureMetal::Options::Options ( int argc, char ** argv ) :
     _input_file ( "" ),
-    _restart ( false )
+    _restart ( false ),
+    _ensemble ( false )
 {
     if ( argc < 2 || argc > 3 ) {
         throw std::runtime_error ( options_number_error_msg );
     }
-    _restart = argc == 3;
-    if ( _restart ) {
+    if ( argc == 3 ) {
         std::string option = std::string ( argv[1] );
-        if ( option != "--restart" ) {
+        _restart = option == "--restart";
+        _ensemble = option == "--ensemble";
+        if ( !_restart && !_ensemble ) {
             throw std::runtime_error ( unknown_option_msg + option );
         }
     }
@@ -29,6 +29,7 @@ class Options
 {
     std::string _input_file;
     bool _restart;
+    bool _ensemble;
 
     Options ( const Options & other ) = delete;
     Options & operator= ( const Options & other ) = delete;
@@ -40,6 +41,7 @@ public:
 
     inline const std::string & input_file () const;
     inline const bool & restart () const;
+    inline const bool & ensemble () const;
 };
 
 inline const std::string & Options::input_file () const
@@ -52,6 +54,11 @@ inline const bool & Options::restart() const
     return _restart;
 }
 
+inline const bool & Options::ensemble() const
+{
+    return _ensemble;
+}
+
 }
 
 #endif // PUREMETAL_OPTIONS_HPP
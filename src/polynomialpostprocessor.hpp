@@ -35,14 +35,14 @@ class PolynomialPostProcessor : public PostProcessor
     bool operator== ( const PolynomialPostProcessor & other ) const = delete;
 
 public:
-    inline PolynomialPostProcessor ( const double & r0, const std::string & path, const std::string & name, const bool & restart );
+    inline PolynomialPostProcessor ( const double & r0, const std::string & path, const std::string & name, const bool & restart, const bool & log_delt );
     ~PolynomialPostProcessor() = default;
 
     inline Interpolant * create_interpolant ( const double * x, const double * y, unsigned n ) override;
 };
 
-PolynomialPostProcessor::PolynomialPostProcessor ( const double & r0, const std::string & path, const std::string & name, const bool & restart )
-    : PostProcessor ( r0, path, name, restart ) {}
+PolynomialPostProcessor::PolynomialPostProcessor ( const double & r0, const std::string & path, const std::string & name, const bool & restart, const bool & log_delt )
+    : PostProcessor ( r0, path, name, restart, log_delt ) {}
 
 Interpolant * PolynomialPostProcessor::create_interpolant ( const double * x, const double * y, unsigned int n )
 {
@@ -19,29 +19,57 @@
 
 #include "postprocessor.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 #include <vector>
 
 #include <gsl/gsl_fit.h>
 
 #include "approximation.hpp"
+#include "boundary.hpp"
+#include "decomposition.hpp"
 #include "field.hpp"
 #include "interpolant.hpp"
 
-void PureMetal::PostProcessor::process ( const Approximation * approximation, const unsigned & ts, const Field * psi, const double & delt )
+// steps is the number of timesteps since the previous call, of delt each, and time that of timestep ts. Decomposed grids gather the cells the tip
+// is fitted to on the rank owning the tip row, which computes and records it and broadcasts the results
+void PureMetal::PostProcessor::process ( const Approximation * approximation, const unsigned & ts, const double & time, const Field * psi, const double & delt, const unsigned & steps )
 {
     switch ( approximation->type() ) {
     case ApproximationType::QuarterDomain: {
-        const unsigned & Nx = approximation->size ( 0u );
+        const Decomposition * decomposition = approximation->decomposition();
+        // global indices, x and y take local ones
+        const unsigned & Nx = approximation->global_size ( 0u );
+        const unsigned & Ny = approximation->global_size ( 1u );
+        const unsigned & ox = approximation->offset ( 0u );
+        const unsigned & oy = approximation->offset ( 1u );
         unsigned i0, cell0;
-        cell0 = i0 = approximation->i ( _x0 );
-        while ( psi->at ( i0, 0u ) > 0. ) {
-            ++i0;
-            if ( i0 == Nx ) {
-                --i0;
+        cell0 = i0 = approximation->i ( _x0 ) + ox;
+        if ( decomposition ) {
+            i0 = std::numeric_limits<unsigned>::max();
+            if ( oy == 0u ) {
+                for ( unsigned i = std::max ( cell0, ox ); i < ox + approximation->size ( 0u ); ++i ) {
+                    if ( ! ( psi->at ( i - ox, 0u ) > 0. ) ) {
+                        i0 = i;
+                        break;
+                    }
+                }
+            }
+            decomposition->min ( &i0, 1u );
+            if ( i0 >= Nx ) {
                 return;
             }
-        } //i0 is te first non positive index
+        } else {
+            while ( psi->at ( i0, 0u ) > 0. ) {
+                ++i0;
+                if ( i0 == Nx ) {
+                    --i0;
+                    return;
+                }
+            } //i0 is te first non positive index
+        }
+        const int root = decomposition ? decomposition->owner ( i0, 0u ) : 0;
 
 //         if ( - ( *psi ) ( i0, 0 ) > ( *psi ) ( i0 - 1, 0 ) )
         i0 += 1;
@@ -52,87 +80,153 @@ void PureMetal::PostProcessor::process ( const Approximation * approximation, co
         }
         i0 -= 4;
 
-        double xi[5], y2j[3];
-        for ( unsigned i = 0u; i < 5u; ++i ) {
-            xi[i] = approximation->x ( i0 + i );
-        }
-        for ( unsigned j = 0u; j < 3u; ++j ) {
-            y2j[j] = approximation->y ( j );
-            y2j[j] *= y2j[j];
-        }
-
-        double x0j[3], dxpsij[3];
-        for ( unsigned j = 0; j < 3; ++j ) {
-            double _psi[5];
-            for ( unsigned i = 0; i < 5; ++i ) {
-                _psi[i] = psi->at ( i0 + i, j );
+        // psi around the tip and, per column up to the tip, the first row where psi is not positive with the
+        // values either side of it: owners contribute their cells, which are summed on the root
+        std::vector<unsigned> contour_j;
+        std::vector<double> values;
+        if ( decomposition ) {
+            const unsigned columns = std::min ( i0 + 5u, Nx );
+            const unsigned & nx = approximation->size ( 0u ), & ny = approximation->size ( 1u );
+            auto owned = [ & ] ( const unsigned & i, const unsigned & j ) {
+                return i >= ox && i < ox + nx && j >= oy && j < oy + ny;
+            };
+            contour_j.assign ( columns, std::numeric_limits<unsigned>::max() );
+            for ( unsigned i = ox; i < std::min ( columns, ox + nx ); ++i ) {
+                for ( unsigned j = oy; j < oy + ny; ++j ) {
+                    if ( ! ( psi->at ( i - ox, j - oy ) > 0. ) ) {
+                        contour_j[i] = j;
+                        break;
+                    }
+                }
+            }
+            decomposition->min ( contour_j.data(), columns );
+            values.assign ( 15u + 2u * columns, 0. );
+            for ( unsigned i = 0u; i < 5u; ++i ) {
+                for ( unsigned j = 0u; j < 3u; ++j ) {
+                    const unsigned k = ReflectingBoundary::index ( static_cast<int> ( i0 + i ), Nx );
+                    if ( owned ( k, j ) ) {
+                        values[3u * i + j] = psi->at ( k - ox, j - oy );
+                    }
+                }
             }
-            Interpolant * ppsij = this->create_interpolant ( xi, _psi, 5 );
-            x0j[j] = ppsij->root ( xi[0], xi[4] );
-            dxpsij[j] = ppsij->derivative ( x0j[0] );
-            x0j[j] = ppsij->root ( xi[0], xi[4] );
-            delete ppsij;
+            for ( unsigned i = 0u; i < columns; ++i ) {
+                contour_j[i] = std::min ( contour_j[i], Ny );
+                for ( unsigned side = 0u; side < 2u; ++side ) {
+                    const unsigned k = ReflectingBoundary::index ( static_cast<int> ( contour_j[i] + side ) - 1, Ny );
+                    if ( owned ( i, k ) ) {
+                        values[15u + 2u * i + side] = psi->at ( i - ox, k - oy );
+                    }
+                }
+            }
+            decomposition->sum ( values.data(), values.size(), root );
         }
+        auto block = [ & ] ( const unsigned & i, const unsigned & j ) -> double {
+            return decomposition ? values[3u * i + j] : psi->at ( i0 + i, j );
+        };
+
+        if ( !decomposition || decomposition->rank() == root ) {
+            double xi[5], y2j[3];
+            for ( unsigned i = 0u; i < 5u; ++i ) {
+                xi[i] = approximation->x ( i0 + i - ox );
+            }
+            for ( unsigned j = 0u; j < 3u; ++j ) {
+                y2j[j] = approximation->y ( j - oy );
+                y2j[j] *= y2j[j];
+            }
 
-        _x = x0j[0];
-
-        _v = ( _x - _x0 ) / delt;
-
-        Interpolant * px0 = this->create_interpolant ( y2j, x0j, 3 );
-        _k2 = 2 * px0->derivative0();
-
-        double d2ypsii[5];
-        for ( unsigned i = 0; i < 5; ++i ) {
-            double _psi[3];
+            double x0j[3], dxpsij[3];
             for ( unsigned j = 0; j < 3; ++j ) {
-                _psi[j] = psi->at( i0 + i, j );
+                double _psi[5];
+                for ( unsigned i = 0; i < 5; ++i ) {
+                    _psi[i] = block ( i, j );
+                }
+                Interpolant * ppsij = this->create_interpolant ( xi, _psi, 5 );
+                x0j[j] = ppsij->root ( xi[0], xi[4] );
+                dxpsij[j] = ppsij->derivative ( x0j[0] );
+                x0j[j] = ppsij->root ( xi[0], xi[4] );
+                delete ppsij;
             }
-            Interpolant * ppsii = this->create_interpolant ( y2j, _psi, 3 );
-            d2ypsii[i] = 2 * ppsii->derivative0 ();
-            delete ppsii;
-        }
 
-        Interpolant * pd2ypsi = this->create_interpolant ( xi, d2ypsii, 5 );
-        Interpolant * pdxpsi = this->create_interpolant ( y2j, dxpsij, 3 );
+            _x = x0j[0];
 
-        _k1 = ( *pd2ypsi ) ( _x ) / std::abs ( pdxpsi->val0 () );
+            _v = ( _x - _x0 ) / ( delt * steps );
 
-        delete px0;
-        delete pd2ypsi;
-        delete pdxpsi;
+            Interpolant * px0 = this->create_interpolant ( y2j, x0j, 3 );
+            _k2 = 2 * px0->derivative0();
 
-        std::vector<double> xc, y2c; //contour lines
-        for ( unsigned i = 0.; i < approximation->i ( _x ); ++i ) {
-            unsigned j = 0;
-            while ( ( *psi ) ( i, j ) > 0 ) {
-                j++;
+            double d2ypsii[5];
+            for ( unsigned i = 0; i < 5; ++i ) {
+                double _psi[3];
+                for ( unsigned j = 0; j < 3; ++j ) {
+                    _psi[j] = block ( i, j );
+                }
+                Interpolant * ppsii = this->create_interpolant ( y2j, _psi, 3 );
+                d2ypsii[i] = 2 * ppsii->derivative0 ();
+                delete ppsii;
             }
-            double y0 = approximation->y ( j - 1 );
-            const double & dy = approximation->spacing(1);
-            const double & z0 = ( *psi ) ( i, j - 1 );
-            const double & z1 = ( *psi ) ( i, j );
-            double cx = approximation->x ( i );
-            double cy = y0 - ( dy * z0 ) / ( z1 - z0 );
-            if ( cy > .1 * cx ) {
-                xc.push_back ( cx );
-                y2c.push_back ( cy * cy );
-                if ( 2 * cy < cx ) {
-                    break;
+
+            Interpolant * pd2ypsi = this->create_interpolant ( xi, d2ypsii, 5 );
+            Interpolant * pdxpsi = this->create_interpolant ( y2j, dxpsij, 3 );
+
+            _k1 = ( *pd2ypsi ) ( _x ) / std::abs ( pdxpsi->val0 () );
+
+            delete px0;
+            delete pd2ypsi;
+            delete pdxpsi;
+
+            std::vector<double> xc, y2c; //contour lines
+            for ( unsigned i = 0.; i < approximation->i ( _x ) + ox && ( !decomposition || i < contour_j.size() ); ++i ) {
+                unsigned j = 0;
+                double z0, z1;
+                if ( decomposition ) {
+                    j = contour_j[i];
+                    z0 = values[15u + 2u * i];
+                    z1 = values[16u + 2u * i];
+                } else {
+                    while ( psi->at ( i, j ) > 0 ) {
+                        j++;
+                    }
+                    z0 = psi->at ( i, j - 1 );
+                    z1 = psi->at ( i, j );
                 }
+                double y0 = approximation->y ( j - 1 - oy );
+                const double & dy = approximation->spacing(1);
+                double cx = approximation->x ( i - ox );
+                double cy = y0 - ( dy * z0 ) / ( z1 - z0 );
+                if ( cy > .1 * cx ) {
+                    xc.push_back ( cx );
+                    y2c.push_back ( cy * cy );
+                    if ( 2 * cy < cx ) {
+                        break;
+                    }
+                }
+            }
+            double c0, c1, cov00, cov01, cov11, sumsq;
+            if ( xc.size() > 2 ) {
+                gsl_fit_linear ( y2c.data(), 1, xc.data(), 1, xc.size(), &c0, &c1, &cov00, &cov01, &cov11, &sumsq );
+                _kpar = 2 * c1;
+            } else {
+                _kpar = NAN;
+            }
+            
+            y2c.clear();
+            xc.clear();
+
+            if ( _log_delt ) {
+                _out_dat->add ( ts, time, _x, _v, _k1, _k2, _kpar, delt );
+            } else {
+                _out_dat->add ( ts, time, _x, _v, _k1, _k2, _kpar );
             }
         }
-        double c0, c1, cov00, cov01, cov11, sumsq;
-        if ( xc.size() > 2 ) {
-            gsl_fit_linear ( y2c.data(), 1, xc.data(), 1, xc.size(), &c0, &c1, &cov00, &cov01, &cov11, &sumsq );
-            _kpar = 2 * c1;
-        } else {
-            _kpar = NAN;
+        if ( decomposition ) {
+            double results[5] = { _x, _v, _k1, _k2, _kpar };
+            decomposition->broadcast ( results, 5u, root );
+            _x = results[0];
+            _v = results[1];
+            _k1 = results[2];
+            _k2 = results[3];
+            _kpar = results[4];
         }
-        
-        y2c.clear();
-        xc.clear();
-
-        _out_dat->add ( ts, ts * delt, _x, _v, _k1, _k2, _kpar );
         _x0 = _x;
         _v0 = _v;
     }
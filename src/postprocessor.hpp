@@ -49,8 +49,9 @@ protected:
     double _dt0;
 
     DatFile * _out_dat;
+    const bool _log_delt;
 
-    inline PostProcessor ( const double & r0, const std::string & path, const std::string & name, const bool & restart );
+    inline PostProcessor ( const double & r0, const std::string & path, const std::string & name, const bool & restart, const bool & log_delt );
 
     virtual Interpolant * create_interpolant ( const double x[], const double y[], unsigned n ) = 0;
 
@@ -62,13 +63,15 @@ public:
     inline const double & tip_k1() const;
     inline const double & tip_k2() const;
     inline const double & tip_kpar() const;
+    inline void shift ( const double & dx );
 
-    void process ( const Approximation * approximation, const unsigned & ts, const Field * psi, const double & delt );
+    void process ( const Approximation * approximation, const unsigned & ts, const double & time, const Field * psi, const double & delt, const unsigned & steps );
 };
 
 }
 
-PureMetal::PostProcessor::PostProcessor ( const double & r0, const std::string & path, const std::string & name, const bool & restart )
+// log_delt adds the delt of each timestep to the records, as adaptive runs vary it
+PureMetal::PostProcessor::PostProcessor ( const double & r0, const std::string & path, const std::string & name, const bool & restart, const bool & log_delt )
     : _x ( r0 ),
       _x0 ( _x ),
       _v ( 0. ),
@@ -80,7 +83,8 @@ PureMetal::PostProcessor::PostProcessor ( const double & r0, const std::string &
       _t0 ( 0. ),
       _dt ( 0. ),
       _dt0 ( 0. ),
-      _out_dat ( new DatFile ( path, name, restart ) )
+      _out_dat ( new DatFile ( path, name, restart ) ),
+      _log_delt ( log_delt )
 {}
 
 PureMetal::PostProcessor::~PostProcessor()
@@ -114,4 +118,12 @@ const double & PureMetal::PostProcessor::tip_kpar() const
     return _kpar;
 }
 
+// the frame moved by dx along x ( see Simulation::shift_frame ): positions are kept relative to it,
+// the next velocity being taken over the same frame
+void PureMetal::PostProcessor::shift ( const double & dx )
+{
+    _x -= dx;
+    _x0 -= dx;
+}
+
 #endif // PUREMETAL_POSTPROCESSOR_HPP
@@ -0,0 +1,110 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "precisionreport.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+
+#include "decomposition.hpp"
+#include "postprocessor.hpp"
+#include "simulation.hpp"
+#include "specifications.hpp"
+
+namespace
+{
+
+const char * const quantities[5] = { "x", "v", "k1", "k2", "kpar" };
+
+}
+
+// the reference, with u on the grid, keeps its tip files in <filebase>/reference
+// and never saves fields; decomposed runs decompose it alike and write the report from rank 0
+PureMetal::PrecisionReport::PrecisionReport ( const Specifications * specs, ThreadPool * pool, Decomposition * decomposition )
+    : _path ( specs->out_path() ),
+      _label ( "u on a grid " + std::to_string ( specs->coarse_factor() ) + " times coarser" ),
+      _writer ( !decomposition || decomposition->rank() == 0 ),
+      _reference ( new Simulation ( specs, pool, decomposition, 1u, specs->out_path() + "/reference" ) ),
+      _samples ( 0u ),
+      _ts ( 0u )
+{
+    for ( unsigned q = 0u; q < 5u; ++q ) {
+        _max_error[q] = _max_relative_error[q] = 0.;
+    }
+}
+
+PureMetal::PrecisionReport::~PrecisionReport()
+{
+    delete _reference;
+}
+
+void PureMetal::PrecisionReport::start ( const double & delt, const unsigned & timesteps )
+{
+    _reference->start ( delt, timesteps );
+}
+
+void PureMetal::PrecisionReport::start ( const double & delt, const double & steady_state_threshold, const unsigned & window_size )
+{
+    _reference->start ( delt, steady_state_threshold, window_size );
+}
+
+// advances the reference up to the timestep of simulation and compares them there
+void PureMetal::PrecisionReport::compare ( const Simulation & simulation )
+{
+    bool running = true;
+    while ( running && _reference->timestep() < simulation.timestep() ) {
+        running = _reference->next();
+    }
+    if ( _reference->timestep() != simulation.timestep() ) {
+        return;
+    }
+    const PostProcessor * reduced = simulation.post_processor();
+    const PostProcessor * reference = _reference->post_processor();
+    const double values[5] = { reduced->tip_position(), reduced->tip_velocity(), reduced->tip_k1(), reduced->tip_k2(), reduced->tip_kpar() };
+    const double references[5] = { reference->tip_position(), reference->tip_velocity(), reference->tip_k1(), reference->tip_k2(), reference->tip_kpar() };
+    for ( unsigned q = 0u; q < 5u; ++q ) {
+        if ( !std::isfinite ( values[q] ) || !std::isfinite ( references[q] ) ) {
+            continue;
+        }
+        const double error = std::abs ( values[q] - references[q] );
+        _max_error[q] = std::max ( _max_error[q], error );
+        if ( references[q] != 0. ) {
+            _max_relative_error[q] = std::max ( _max_relative_error[q], error / std::abs ( references[q] ) );
+        }
+    }
+    ++_samples;
+    _ts = simulation.timestep();
+}
+
+void PureMetal::PrecisionReport::save() const
+{
+    if ( !_writer ) {
+        return;
+    }
+    std::ofstream out;
+    out.open ( _path + "/precision_report.dat", std::ios_base::trunc );
+    out << "# " << _label << " against u on the grid: " << _samples << " samples up to timestep " << _ts << std::endl;
+    out << "# quantity max_abs_error max_rel_error" << std::endl;
+    for ( unsigned q = 0u; q < 5u; ++q ) {
+        out << std::setprecision ( 16 ) << std::scientific << quantities[q] << " " << _max_error[q] << " " << _max_relative_error[q] << std::endl;
+    }
+    out.close();
+}
@@ -0,0 +1,62 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PUREMETAL_PRECISIONREPORT_HPP
+#define PUREMETAL_PRECISIONREPORT_HPP
+
+#include <string>
+
+namespace PureMetal
+{
+
+class Decomposition;
+class Simulation;
+class Specifications;
+class ThreadPool;
+
+// runs a reference in lockstep with a simulation stepping u on a coarser grid ( see CoarseDiffusion ) and
+// records the largest differences in the tip quantities of their first postprocessor
+class PrecisionReport
+{
+    const std::string _path;
+    const std::string _label;
+    const bool _writer;
+    Simulation * _reference;
+    unsigned _samples;
+    unsigned _ts;
+    double _max_error[5];
+    double _max_relative_error[5];
+
+    PrecisionReport ( const PrecisionReport & other ) = delete;
+    PrecisionReport & operator= ( const PrecisionReport & other ) = delete;
+    bool operator== ( const PrecisionReport & other ) const = delete;
+
+public:
+    PrecisionReport ( const Specifications * specs, ThreadPool * pool, Decomposition * decomposition );
+    ~PrecisionReport();
+
+    void start ( const double & delt, const unsigned & timesteps );
+    void start ( const double & delt, const double & steady_state_threshold, const unsigned & window_size );
+    void compare ( const Simulation & simulation );
+    void save() const;
+};
+
+}
+
+#endif // PUREMETAL_PRECISIONREPORT_HPP
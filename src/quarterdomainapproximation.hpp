@@ -28,18 +28,19 @@
 namespace PureMetal
 {
 
-class QuarterDomainApproximation : public Approximation
+class QuarterDomainApproximation final : public Approximation
 {
     QuarterDomainApproximation ( const QuarterDomainApproximation & other ) = delete;
     QuarterDomainApproximation & operator= ( const QuarterDomainApproximation & other ) = delete;
     bool operator== ( const QuarterDomainApproximation & other ) const = delete;
 
 public:
-    QuarterDomainApproximation ( const double * upper, const double * spacing );
+    inline QuarterDomainApproximation ( const double * upper, const double * spacing );
     ~QuarterDomainApproximation() = default;
 
     inline Field * create_field ( const double & value ) const override;
     inline Field * create_field ( const std::function<double ( unsigned, unsigned ) > & function ) const override;
+    inline Field * create_field ( double * origin, const unsigned & stride ) const override;
 
     inline ApproximationType type() const override;
 
@@ -71,6 +72,11 @@ PureMetal::Field * PureMetal::QuarterDomainApproximation::create_field ( const s
     return new QuarterDomainField ( this, function );
 }
 
+PureMetal::Field * PureMetal::QuarterDomainApproximation::create_field ( double * origin, const unsigned & stride ) const
+{
+    return new QuarterDomainField ( this, origin, stride );
+}
+
 PureMetal::ApproximationType PureMetal::QuarterDomainApproximation::type() const
 {
     return ApproximationType::QuarterDomain;
@@ -78,22 +84,22 @@ PureMetal::ApproximationType PureMetal::QuarterDomainApproximation::type() const
 
 unsigned PureMetal::QuarterDomainApproximation::i ( const double & x ) const
 {
-    return static_cast<unsigned> ( x / _spacing[0] );
+    return static_cast<unsigned> ( x / _spacing[0] ) - _offset[0];
 }
 
 unsigned PureMetal::QuarterDomainApproximation::j ( const double & y ) const
 {
-    return static_cast<unsigned> ( y / _spacing[1] );
+    return static_cast<unsigned> ( y / _spacing[1] ) - _offset[1];
 }
 
 double PureMetal::QuarterDomainApproximation::x ( const unsigned & i ) const
 {
-    return _spacing[0] * static_cast<double> ( i );
+    return _spacing[0] * static_cast<double> ( i + _offset[0] );
 }
 
 double PureMetal::QuarterDomainApproximation::y ( const unsigned & j ) const
 {
-    return _spacing[1] * static_cast<double> ( j );
+    return _spacing[1] * static_cast<double> ( j + _offset[1] );
 }
 
 
@@ -34,6 +34,7 @@ class QuarterDomainField : public Field
 public:
     inline QuarterDomainField ( const Approximation * approximation, const double & value );
     inline QuarterDomainField ( const Approximation * approximation, const std::function<double ( unsigned, unsigned ) > & function );
+    inline QuarterDomainField ( const Approximation * approximation, double * origin, const unsigned & stride );
     ~QuarterDomainField() = default;
 };
 
@@ -45,4 +46,7 @@ PureMetal::QuarterDomainField::QuarterDomainField ( const PureMetal::Approximati
 PureMetal::QuarterDomainField::QuarterDomainField ( const PureMetal::Approximation * approximation, const std::function< double ( unsigned, unsigned ) > & function )
     : Field ( approximation, function ) {}
 
+PureMetal::QuarterDomainField::QuarterDomainField ( const PureMetal::Approximation * approximation, double * origin, const unsigned & stride )
+    : Field ( approximation, origin, stride ) {}
+
 #endif // PUREMETAL_QUARTERDOMAINFIELD_HPP
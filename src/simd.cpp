@@ -0,0 +1,262 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "simd.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#if defined ( __GNUC__ ) && ( defined ( __x86_64__ ) || defined ( __i386__ ) )
+#define PUREMETAL_X86_SIMD
+#include <immintrin.h>
+#endif
+
+// The vector paths perform exactly the operations of AnisotropicCell and StencilKernel::step, in the same
+// order and without contraction (this file is built with -ffp-contract=off): results are bit-identical to
+// the scalar kernel. The n2 > tolerance branches become masked blends.
+
+#ifdef PUREMETAL_X86_SIMD
+
+namespace
+{
+
+// a2 and bxy are the three window rows j-1, j, j+1
+__attribute__ ( ( target ( "avx2" ) ) )
+int derive_row_avx2 ( const double * p, const int & stride, const int & n, const PureMetal::StencilCoefficients & c,
+                      double * psix, double * psiy, double * a2, double * bxy )
+{
+    const __m256d two_hx = _mm256_set1_pd ( 2.*c.hx ), two_hy = _mm256_set1_pd ( 2.*c.hy );
+    const __m256d one = _mm256_set1_pd ( 1. ), three = _mm256_set1_pd ( 3. ), four = _mm256_set1_pd ( 4. ), zero = _mm256_setzero_pd();
+    const __m256d epsilon = _mm256_set1_pd ( c.epsilon ), tolerance = _mm256_set1_pd ( c.tolerance ), epsilon16 = _mm256_set1_pd ( 16.*c.epsilon );
+    int i = 0;
+    for ( ; i + 4 <= n; i += 4 ) {
+        const __m256d x = _mm256_div_pd ( _mm256_sub_pd ( _mm256_loadu_pd ( p + i + 1 ), _mm256_loadu_pd ( p + i - 1 ) ), two_hx );
+        const __m256d y = _mm256_div_pd ( _mm256_sub_pd ( _mm256_loadu_pd ( p + i + stride ), _mm256_loadu_pd ( p + i - stride ) ), two_hy );
+        const __m256d x2 = _mm256_mul_pd ( x, x ), y2 = _mm256_mul_pd ( y, y );
+        const __m256d n2 = _mm256_add_pd ( x2, y2 );
+        const __m256d n4 = _mm256_mul_pd ( n2, n2 );
+        const __m256d mask = _mm256_cmp_pd ( n2, tolerance, _CMP_GT_OQ );
+        const __m256d x4 = _mm256_mul_pd ( _mm256_mul_pd ( x2, x ), x ), y4 = _mm256_mul_pd ( _mm256_mul_pd ( y2, y ), y );
+        __m256d a = _mm256_sub_pd ( _mm256_div_pd ( _mm256_mul_pd ( four, _mm256_add_pd ( x4, y4 ) ), n4 ), three );
+        a = _mm256_blendv_pd ( one, _mm256_add_pd ( one, _mm256_mul_pd ( epsilon, a ) ), mask );
+        __m256d b = _mm256_mul_pd ( _mm256_mul_pd ( _mm256_mul_pd ( _mm256_mul_pd ( epsilon16, a ), x ), y ), _mm256_sub_pd ( x2, y2 ) );
+        b = _mm256_blendv_pd ( zero, _mm256_div_pd ( b, n4 ), mask );
+        _mm256_storeu_pd ( psix + i, x );
+        _mm256_storeu_pd ( psiy + i, y );
+        _mm256_storeu_pd ( a2 + i, _mm256_mul_pd ( a, a ) );
+        _mm256_storeu_pd ( bxy + i, b );
+    }
+    return i;
+}
+
+__attribute__ ( ( target ( "avx2" ) ) )
+int increment_row_avx2 ( const double * p, const double * v, const int & stride, const int & n, const PureMetal::StencilCoefficients & c,
+                         const double * psix, const double * psiy, const double * const * a2, const double * const * bxy,
+                         double * psi, double * u, double * bounds )
+{
+    const __m256d hx = _mm256_set1_pd ( c.hx ), hy = _mm256_set1_pd ( c.hy );
+    const __m256d two_hx = _mm256_set1_pd ( 2.*c.hx ), two_hy = _mm256_set1_pd ( 2.*c.hy );
+    const __m256d one = _mm256_set1_pd ( 1. ), two = _mm256_set1_pd ( 2. );
+    const __m256d lambda = _mm256_set1_pd ( c.lambda ), alpha = _mm256_set1_pd ( c.alpha ), delt = _mm256_set1_pd ( c.delt );
+    __m256d min = _mm256_set1_pd ( std::numeric_limits<double>::infinity() ), max = _mm256_set1_pd ( -std::numeric_limits<double>::infinity() );
+    __m256d a2max = _mm256_setzero_pd();
+    int i = 0;
+    for ( ; i + 4 <= n; i += 4 ) {
+        const __m256d pc = _mm256_loadu_pd ( p + i ), vc = _mm256_loadu_pd ( v + i );
+        const __m256d p2 = _mm256_mul_pd ( two, pc ), v2 = _mm256_mul_pd ( two, vc );
+        __m256d source = _mm256_sub_pd ( one, _mm256_mul_pd ( pc, pc ) );
+        source = _mm256_mul_pd ( source, _mm256_sub_pd ( pc, _mm256_mul_pd ( _mm256_mul_pd ( lambda, vc ), source ) ) );
+        const __m256d lap_psi = _mm256_add_pd (
+                                    _mm256_div_pd ( _mm256_sub_pd ( _mm256_add_pd ( _mm256_loadu_pd ( p + i + 1 ), _mm256_loadu_pd ( p + i - 1 ) ), p2 ), hx ),
+                                    _mm256_div_pd ( _mm256_sub_pd ( _mm256_add_pd ( _mm256_loadu_pd ( p + i + stride ), _mm256_loadu_pd ( p + i - stride ) ), p2 ), hy ) );
+        const __m256d a2c = _mm256_loadu_pd ( a2[1] + i );
+        const __m256d a2x = _mm256_div_pd ( _mm256_sub_pd ( _mm256_loadu_pd ( a2[1] + i + 1 ), _mm256_loadu_pd ( a2[1] + i - 1 ) ), two_hx );
+        const __m256d a2y = _mm256_div_pd ( _mm256_sub_pd ( _mm256_loadu_pd ( a2[2] + i ), _mm256_loadu_pd ( a2[0] + i ) ), two_hy );
+        const __m256d bxyx = _mm256_div_pd ( _mm256_sub_pd ( _mm256_loadu_pd ( bxy[1] + i + 1 ), _mm256_loadu_pd ( bxy[1] + i - 1 ) ), two_hx );
+        const __m256d bxyy = _mm256_div_pd ( _mm256_sub_pd ( _mm256_loadu_pd ( bxy[2] + i ), _mm256_loadu_pd ( bxy[0] + i ) ), two_hy );
+        __m256d sum = _mm256_add_pd ( _mm256_mul_pd ( lap_psi, a2c ), _mm256_mul_pd ( _mm256_sub_pd ( a2x, bxyy ), _mm256_loadu_pd ( psix + i ) ) );
+        sum = _mm256_add_pd ( _mm256_add_pd ( sum, _mm256_mul_pd ( _mm256_add_pd ( bxyx, a2y ), _mm256_loadu_pd ( psiy + i ) ) ), source );
+        const __m256d dpsi = _mm256_div_pd ( _mm256_mul_pd ( delt, sum ), a2c );
+        _mm256_storeu_pd ( psi + i, _mm256_add_pd ( pc, dpsi ) );
+        if ( u ) {
+            const __m256d lap_u = _mm256_add_pd (
+                                      _mm256_div_pd ( _mm256_sub_pd ( _mm256_add_pd ( _mm256_loadu_pd ( v + i + 1 ), _mm256_loadu_pd ( v + i - 1 ) ), v2 ), hx ),
+                                      _mm256_div_pd ( _mm256_sub_pd ( _mm256_add_pd ( _mm256_loadu_pd ( v + i + stride ), _mm256_loadu_pd ( v + i - stride ) ), v2 ), hy ) );
+            const __m256d du = _mm256_add_pd ( _mm256_mul_pd ( _mm256_mul_pd ( delt, lap_u ), alpha ), _mm256_div_pd ( dpsi, two ) );
+            const __m256d uc = _mm256_add_pd ( vc, du );
+            _mm256_storeu_pd ( u + i, uc );
+            // the operand order keeps the accumulator when uc is NaN
+            min = _mm256_min_pd ( uc, min );
+            max = _mm256_max_pd ( uc, max );
+        }
+        a2max = _mm256_max_pd ( a2c, a2max );
+    }
+    if ( bounds ) {
+        double lanes[3][4];
+        _mm256_storeu_pd ( lanes[0], min );
+        _mm256_storeu_pd ( lanes[1], max );
+        _mm256_storeu_pd ( lanes[2], a2max );
+        for ( int k = 0; k < 4; ++k ) {
+            bounds[0] = lanes[0][k] < bounds[0] ? lanes[0][k] : bounds[0];
+            bounds[1] = lanes[1][k] > bounds[1] ? lanes[1][k] : bounds[1];
+            bounds[2] = lanes[2][k] > bounds[2] ? lanes[2][k] : bounds[2];
+        }
+    }
+    return i;
+}
+
+__attribute__ ( ( target ( "avx512f" ) ) )
+int derive_row_avx512 ( const double * p, const int & stride, const int & n, const PureMetal::StencilCoefficients & c,
+                        double * psix, double * psiy, double * a2, double * bxy )
+{
+    const __m512d two_hx = _mm512_set1_pd ( 2.*c.hx ), two_hy = _mm512_set1_pd ( 2.*c.hy );
+    const __m512d one = _mm512_set1_pd ( 1. ), three = _mm512_set1_pd ( 3. ), four = _mm512_set1_pd ( 4. ), zero = _mm512_setzero_pd();
+    const __m512d epsilon = _mm512_set1_pd ( c.epsilon ), tolerance = _mm512_set1_pd ( c.tolerance ), epsilon16 = _mm512_set1_pd ( 16.*c.epsilon );
+    int i = 0;
+    for ( ; i + 8 <= n; i += 8 ) {
+        const __m512d x = _mm512_div_pd ( _mm512_sub_pd ( _mm512_loadu_pd ( p + i + 1 ), _mm512_loadu_pd ( p + i - 1 ) ), two_hx );
+        const __m512d y = _mm512_div_pd ( _mm512_sub_pd ( _mm512_loadu_pd ( p + i + stride ), _mm512_loadu_pd ( p + i - stride ) ), two_hy );
+        const __m512d x2 = _mm512_mul_pd ( x, x ), y2 = _mm512_mul_pd ( y, y );
+        const __m512d n2 = _mm512_add_pd ( x2, y2 );
+        const __m512d n4 = _mm512_mul_pd ( n2, n2 );
+        const __mmask8 mask = _mm512_cmp_pd_mask ( n2, tolerance, _CMP_GT_OQ );
+        const __m512d x4 = _mm512_mul_pd ( _mm512_mul_pd ( x2, x ), x ), y4 = _mm512_mul_pd ( _mm512_mul_pd ( y2, y ), y );
+        __m512d a = _mm512_sub_pd ( _mm512_div_pd ( _mm512_mul_pd ( four, _mm512_add_pd ( x4, y4 ) ), n4 ), three );
+        a = _mm512_mask_blend_pd ( mask, one, _mm512_add_pd ( one, _mm512_mul_pd ( epsilon, a ) ) );
+        __m512d b = _mm512_mul_pd ( _mm512_mul_pd ( _mm512_mul_pd ( _mm512_mul_pd ( epsilon16, a ), x ), y ), _mm512_sub_pd ( x2, y2 ) );
+        b = _mm512_mask_blend_pd ( mask, zero, _mm512_div_pd ( b, n4 ) );
+        _mm512_storeu_pd ( psix + i, x );
+        _mm512_storeu_pd ( psiy + i, y );
+        _mm512_storeu_pd ( a2 + i, _mm512_mul_pd ( a, a ) );
+        _mm512_storeu_pd ( bxy + i, b );
+    }
+    return i;
+}
+
+__attribute__ ( ( target ( "avx512f" ) ) )
+int increment_row_avx512 ( const double * p, const double * v, const int & stride, const int & n, const PureMetal::StencilCoefficients & c,
+                           const double * psix, const double * psiy, const double * const * a2, const double * const * bxy,
+                           double * psi, double * u, double * bounds )
+{
+    const __m512d hx = _mm512_set1_pd ( c.hx ), hy = _mm512_set1_pd ( c.hy );
+    const __m512d two_hx = _mm512_set1_pd ( 2.*c.hx ), two_hy = _mm512_set1_pd ( 2.*c.hy );
+    const __m512d one = _mm512_set1_pd ( 1. ), two = _mm512_set1_pd ( 2. );
+    const __m512d lambda = _mm512_set1_pd ( c.lambda ), alpha = _mm512_set1_pd ( c.alpha ), delt = _mm512_set1_pd ( c.delt );
+    __m512d min = _mm512_set1_pd ( std::numeric_limits<double>::infinity() ), max = _mm512_set1_pd ( -std::numeric_limits<double>::infinity() );
+    __m512d a2max = _mm512_setzero_pd();
+    int i = 0;
+    for ( ; i + 8 <= n; i += 8 ) {
+        const __m512d pc = _mm512_loadu_pd ( p + i ), vc = _mm512_loadu_pd ( v + i );
+        const __m512d p2 = _mm512_mul_pd ( two, pc ), v2 = _mm512_mul_pd ( two, vc );
+        __m512d source = _mm512_sub_pd ( one, _mm512_mul_pd ( pc, pc ) );
+        source = _mm512_mul_pd ( source, _mm512_sub_pd ( pc, _mm512_mul_pd ( _mm512_mul_pd ( lambda, vc ), source ) ) );
+        const __m512d lap_psi = _mm512_add_pd (
+                                    _mm512_div_pd ( _mm512_sub_pd ( _mm512_add_pd ( _mm512_loadu_pd ( p + i + 1 ), _mm512_loadu_pd ( p + i - 1 ) ), p2 ), hx ),
+                                    _mm512_div_pd ( _mm512_sub_pd ( _mm512_add_pd ( _mm512_loadu_pd ( p + i + stride ), _mm512_loadu_pd ( p + i - stride ) ), p2 ), hy ) );
+        const __m512d a2c = _mm512_loadu_pd ( a2[1] + i );
+        const __m512d a2x = _mm512_div_pd ( _mm512_sub_pd ( _mm512_loadu_pd ( a2[1] + i + 1 ), _mm512_loadu_pd ( a2[1] + i - 1 ) ), two_hx );
+        const __m512d a2y = _mm512_div_pd ( _mm512_sub_pd ( _mm512_loadu_pd ( a2[2] + i ), _mm512_loadu_pd ( a2[0] + i ) ), two_hy );
+        const __m512d bxyx = _mm512_div_pd ( _mm512_sub_pd ( _mm512_loadu_pd ( bxy[1] + i + 1 ), _mm512_loadu_pd ( bxy[1] + i - 1 ) ), two_hx );
+        const __m512d bxyy = _mm512_div_pd ( _mm512_sub_pd ( _mm512_loadu_pd ( bxy[2] + i ), _mm512_loadu_pd ( bxy[0] + i ) ), two_hy );
+        __m512d sum = _mm512_add_pd ( _mm512_mul_pd ( lap_psi, a2c ), _mm512_mul_pd ( _mm512_sub_pd ( a2x, bxyy ), _mm512_loadu_pd ( psix + i ) ) );
+        sum = _mm512_add_pd ( _mm512_add_pd ( sum, _mm512_mul_pd ( _mm512_add_pd ( bxyx, a2y ), _mm512_loadu_pd ( psiy + i ) ) ), source );
+        const __m512d dpsi = _mm512_div_pd ( _mm512_mul_pd ( delt, sum ), a2c );
+        _mm512_storeu_pd ( psi + i, _mm512_add_pd ( pc, dpsi ) );
+        if ( u ) {
+            const __m512d lap_u = _mm512_add_pd (
+                                      _mm512_div_pd ( _mm512_sub_pd ( _mm512_add_pd ( _mm512_loadu_pd ( v + i + 1 ), _mm512_loadu_pd ( v + i - 1 ) ), v2 ), hx ),
+                                      _mm512_div_pd ( _mm512_sub_pd ( _mm512_add_pd ( _mm512_loadu_pd ( v + i + stride ), _mm512_loadu_pd ( v + i - stride ) ), v2 ), hy ) );
+            const __m512d du = _mm512_add_pd ( _mm512_mul_pd ( _mm512_mul_pd ( delt, lap_u ), alpha ), _mm512_div_pd ( dpsi, two ) );
+            const __m512d uc = _mm512_add_pd ( vc, du );
+            _mm512_storeu_pd ( u + i, uc );
+            // ordered compares keep the accumulator when uc is NaN
+            min = _mm512_mask_blend_pd ( _mm512_cmp_pd_mask ( uc, min, _CMP_LT_OQ ), min, uc );
+            max = _mm512_mask_blend_pd ( _mm512_cmp_pd_mask ( uc, max, _CMP_GT_OQ ), max, uc );
+        }
+        a2max = _mm512_mask_blend_pd ( _mm512_cmp_pd_mask ( a2c, a2max, _CMP_GT_OQ ), a2max, a2c );
+    }
+    if ( bounds ) {
+        double lanes[3][8];
+        _mm512_storeu_pd ( lanes[0], min );
+        _mm512_storeu_pd ( lanes[1], max );
+        _mm512_storeu_pd ( lanes[2], a2max );
+        for ( int k = 0; k < 8; ++k ) {
+            bounds[0] = lanes[0][k] < bounds[0] ? lanes[0][k] : bounds[0];
+            bounds[1] = lanes[1][k] > bounds[1] ? lanes[1][k] : bounds[1];
+            bounds[2] = lanes[2][k] > bounds[2] ? lanes[2][k] : bounds[2];
+        }
+    }
+    return i;
+}
+
+}
+
+#endif // PUREMETAL_X86_SIMD
+
+// best instruction set supported by the cpu, PUREMETAL_SIMD=scalar|avx2|avx512 can lower it
+PureMetal::SimdType PureMetal::simd_type()
+{
+    SimdType type = SimdType::scalar;
+#ifdef PUREMETAL_X86_SIMD
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports ( "avx512f" ) ) {
+        type = SimdType::avx512;
+    } else if ( __builtin_cpu_supports ( "avx2" ) ) {
+        type = SimdType::avx2;
+    }
+#endif
+    const char * env = std::getenv ( "PUREMETAL_SIMD" );
+    if ( env ) {
+        if ( !std::strcmp ( env, "scalar" ) ) {
+            type = SimdType::scalar;
+        } else if ( !std::strcmp ( env, "avx2" ) && type == SimdType::avx512 ) {
+            type = SimdType::avx2;
+        }
+    }
+    return type;
+}
+
+PureMetal::DeriveRow PureMetal::derive_row ( const SimdType & type )
+{
+    switch ( type ) {
+#ifdef PUREMETAL_X86_SIMD
+    case SimdType::avx512 :
+        return &derive_row_avx512;
+    case SimdType::avx2 :
+        return &derive_row_avx2;
+#endif
+    default :
+        return nullptr;
+    }
+}
+
+PureMetal::IncrementRow PureMetal::increment_row ( const SimdType & type )
+{
+    switch ( type ) {
+#ifdef PUREMETAL_X86_SIMD
+    case SimdType::avx512 :
+        return &increment_row_avx512;
+    case SimdType::avx2 :
+        return &increment_row_avx2;
+#endif
+    default :
+        return nullptr;
+    }
+}
@@ -0,0 +1,56 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PUREMETAL_SIMD_HPP
+#define PUREMETAL_SIMD_HPP
+
+namespace PureMetal
+{
+
+enum class SimdType
+{
+    scalar, avx2, avx512
+};
+
+struct StencilCoefficients {
+    double hx;
+    double hy;
+    double epsilon;
+    double tolerance;
+    double alpha;
+    double lambda;
+    double delt;
+};
+
+// row functions return the number of leading cells they processed, the caller completes the row;
+// increments write psi = psi0 + dpsi and u = u0 + du. Increments given bounds ( the min and max of u, then the
+// largest a2 ) widen them to the cells they processed, NaN left out; given u nullptr they only write psi
+typedef int ( *DeriveRow ) ( const double * psi0, const int & stride, const int & n, const StencilCoefficients & c,
+                             double * psix, double * psiy, double * a2, double * bxy );
+typedef int ( *IncrementRow ) ( const double * psi0, const double * u0, const int & stride, const int & n, const StencilCoefficients & c,
+                                const double * psix, const double * psiy, const double * const * a2, const double * const * bxy,
+                                double * psi, double * u, double * bounds );
+
+SimdType simd_type();
+DeriveRow derive_row ( const SimdType & type );
+IncrementRow increment_row ( const SimdType & type );
+
+}
+
+#endif // PUREMETAL_SIMD_HPP
@@ -19,11 +19,25 @@
 
 #include "simulation.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
 #include <cmath>
+#include <utility>
 
+#include "allocations.hpp"
 #include "approximation.hpp"
+#include "coarsediffusionkernel.hpp"
+#include "datfile.hpp"
+#include "decomposition.hpp"
+#include "divergencemonitor.hpp"
 #include "field.hpp"
+#include "imexkernel.hpp"
+#include "interleavedfield.hpp"
+#include "kernel.hpp"
 #include "specifications.hpp"
+#include "threadpool.hpp"
+#include "timestepcontroller.hpp"
 #include "postprocessor.hpp"
 #include "messages.hpp"
 #include "visitfile.hpp"
@@ -31,7 +45,14 @@
 #include "polynomialpostprocessor.hpp"
 #include "csplinepostprocessor.hpp"
 
-PureMetal::Simulation::Simulation ( const PureMetal::Specifications * specs ) :
+PureMetal::Simulation::Simulation ( const PureMetal::Specifications * specs, ThreadPool * pool, Decomposition * decomposition ) :
+    Simulation ( specs, pool, decomposition, specs->coarse_diffusion() ? specs->coarse_factor() : 1u, specs->out_path() )
+{}
+
+// decomposed simulations gather the fields they save on rank 0, the only one writing them
+PureMetal::Simulation::Simulation ( const PureMetal::Specifications * specs, ThreadPool * pool, Decomposition * decomposition, const unsigned & coarsening, const std::string & out_path ) :
+    _specs ( specs ),
+    _coarsening ( coarsening ),
     _alpha ( specs->alpha() ),
     _lambda ( specs->alpha() / 0.6267 ),
     _epsilon ( specs->epsilon() ),
@@ -44,6 +65,8 @@ PureMetal::Simulation::Simulation ( const PureMetal::Specifications * specs ) :
     _maxts ( 0u ),
     _ts ( 0u ),
     _threshold ( 0. ),
+    _time ( 0. ),
+    _max_time ( 0. ),
     _steady_state_checkpoint ( false ),
     _mean_v0 ( 0. ),
     _mean_v ( 0. ),
@@ -55,59 +78,140 @@ PureMetal::Simulation::Simulation ( const PureMetal::Specifications * specs ) :
     _mean_kpar ( 0. ),
     _window_size ( 0 ),
     _approximation ( nullptr ),
+    _out_approximation ( nullptr ),
+    _kernel ( nullptr ),
+    _estimator ( nullptr ),
+    _tile_rows ( specs->tile_rows() ),
+    _blocking_depth ( specs->blocking_depth() ),
+    _configured ( false ),
+    _state ( nullptr ),
+    _state0 ( nullptr ),
     _psi ( nullptr ),
     _u ( nullptr ),
     _psi0 ( nullptr ),
     _u0 ( nullptr ),
+    _state_next ( nullptr ),
+    _psi_next ( nullptr ),
+    _u_next ( nullptr ),
     _psix ( nullptr ),
     _psiy ( nullptr ),
     _n2 ( nullptr ),
     _a ( nullptr ),
     _a2 ( nullptr ),
     _bxy ( nullptr ),
-    _out_path ( specs->out_path() ),
+    _out_path ( out_path ),
+    _out_writer ( true ),
     _out_interval ( specs->out_interval() ),
     _out_map (),
     _out_visit ( nullptr ),
     _post_polynomial ( false ),
     _post_cspline ( false ),
-    _post_processors ( )
+    _post_processors ( ),
+    _monitor ( nullptr ),
+    _controller ( nullptr ),
+    _narrow_band ( specs->narrow_band() ),
+    _band_dat ( nullptr ),
+    _frame_offset ( specs->moving_frame() ? specs->frame_offset() : 0. ),
+    _frame_dat ( nullptr )
 {
-    _approximation = Approximation::New ( specs->simulation_type(), specs->upper(), specs->lower(), specs->spacing() );
-
-    _psi = _approximation->create_field ( 0. );
-    _u = _approximation->create_field ( 0. );
-    _psi0 = _approximation->create_field ( 0. );
-    _u0 = _approximation->create_field ( 0. );
-    _psix = _approximation->create_field ( 0. );
-    _psiy = _approximation->create_field ( 0. );
-    _n2 = _approximation->create_field ( 0. );
-    _a = _approximation->create_field ( 0. );
-    _a2 = _approximation->create_field ( 0. );
-    _bxy = _approximation->create_field ( 0. );
+    // growing grids start on the initial one
+    const double * upper = specs->growth() ? specs->growth_initial() : specs->upper();
+    _approximation = Approximation::New ( specs->simulation_type(), upper, specs->lower(), specs->spacing(), decomposition );
+    _approximation->set_pool ( pool );
+    if ( _approximation->decomposition() ) {
+        _out_writer = decomposition->rank() == 0;
+        if ( _out_writer ) {
+            _out_approximation = Approximation::New ( specs->simulation_type(), upper, specs->lower(), specs->spacing(), nullptr );
+        }
+    }
+    _kernel = create_kernel();
+    create_state();
 
+    if ( specs->time_type() == TimeType::adaptive ) {
+        // u diffuses on the coarse grid, whose laplacian has coefficient alpha / coarsening^2 on the scale of the grid
+        _controller = new TimestepController ( _approximation, _alpha / ( _coarsening * _coarsening ), specs->error_tolerance(), specs->safety(), specs->delt_min(), specs->delt_max(), specs->scheme() == SchemeType::imex );
+        _estimator = create_kernel();
+        _blocking_depth = 1u;
+    }
+    // derived fields are only materialised for output, psi and u are looked up at save time
+    // since stepping swaps them with psi0 and u0
     for ( const auto & label : specs->out_labels() ) {
         if ( label == "psi" ) {
-            _out_map[label] = _psi;
+            _out_map[label] = &_psi;
         } else if ( label == "u" ) {
-            _out_map[label] = _u;
+            _out_map[label] = &_u;
         } else if ( label == "psi_x" ) {
-            _out_map[label] = _psix;
+            _psix = _approximation->create_field ( 0. );
+            _out_map[label] = &_psix;
         } else if ( label == "psi_y" ) {
-            _out_map[label] = _psiy;
+            _psiy = _approximation->create_field ( 0. );
+            _out_map[label] = &_psiy;
         } else if ( label == "grad_psi_norm2" ) {
-            _out_map[label] = _n2;
+            _n2 = _approximation->create_field ( 0. );
+            _out_map[label] = &_n2;
         } else if ( label == "A" ) {
-            _out_map[label] = _a;
+            _a = _approximation->create_field ( 0. );
+            _out_map[label] = &_a;
         } else if ( label == "A2" ) {
-            _out_map[label] = _a2;
+            _a2 = _approximation->create_field ( 0. );
+            _out_map[label] = &_a2;
         } else if ( label == "Bxy" ) {
-            _out_map[label] = _bxy;
+            _bxy = _approximation->create_field ( 0. );
+            _out_map[label] = &_bxy;
         }
     }
 
     _post_polynomial = specs->postprocess_polynomial();
     _post_cspline = specs->postprocess_cspline();
+    if ( specs->divergence_check() ) {
+        _monitor = new DivergenceMonitor ( _approximation, specs->divergence_growth(), specs->divergence_window() );
+    }
+}
+
+PureMetal::Kernel * PureMetal::Simulation::create_kernel() const
+{
+    Kernel * kernel = Kernel::New ( _specs->simulation_type(), _approximation, _alpha, _lambda, _epsilon, _tolerance );
+    if ( _specs->scheme() == SchemeType::imex ) {
+        kernel = new ImexKernel ( kernel, _approximation, _alpha );
+    }
+    if ( _coarsening > 1u ) {
+        kernel = new CoarseDiffusionKernel ( kernel, _approximation, _specs->simulation_type(), _alpha, _coarsening );
+    }
+    if ( _specs->divergence_check() ) {
+        kernel->watch_divergence();
+    }
+    if ( _specs->narrow_band() ) {
+        kernel->narrow_band ( _specs->band_delta(), _specs->band_margin(), _specs->band_interval() );
+    }
+    return kernel;
+}
+
+// psi and u, psi0 and u0 and, for adaptive runs, psi_next and u_next on the current grid
+void PureMetal::Simulation::create_state()
+{
+    if ( _specs->layout() == LayoutType::interleaved ) {
+        _state = new InterleavedField ( _approximation, 2u, 0. );
+        _state0 = new InterleavedField ( _approximation, 2u, 0. );
+        _psi = _state->component ( 0u );
+        _u = _state->component ( 1u );
+        _psi0 = _state0->component ( 0u );
+        _u0 = _state0->component ( 1u );
+    } else {
+        _psi = _approximation->create_field ( 0. );
+        _u = _approximation->create_field ( 0. );
+        _psi0 = _approximation->create_field ( 0. );
+        _u0 = _approximation->create_field ( 0. );
+    }
+    if ( _specs->time_type() == TimeType::adaptive ) {
+        if ( _state ) {
+            _state_next = new InterleavedField ( _approximation, 2u, 0. );
+            _psi_next = _state_next->component ( 0u );
+            _u_next = _state_next->component ( 1u );
+        } else {
+            _psi_next = _approximation->create_field ( 0. );
+            _u_next = _approximation->create_field ( 0. );
+        }
+    }
 }
 
 PureMetal::Simulation::~Simulation()
@@ -116,8 +220,15 @@ PureMetal::Simulation::~Simulation()
         delete post_processor;
     }
     _post_processors.clear();
+    delete _frame_dat;
+    delete _band_dat;
+    delete _controller;
+    delete _monitor;
     delete _out_visit;
     _out_map.clear();
+    delete _estimator;
+    delete _kernel;
+    delete _out_approximation;
     delete _approximation;
     delete _bxy;
     delete _a2;
@@ -125,10 +236,18 @@ PureMetal::Simulation::~Simulation()
     delete _n2;
     delete _psiy;
     delete _psix;
-    delete _u0;
-    delete _psi0;
-    delete _u;
-    delete _psi;
+    if ( _state ) {
+        delete _state_next;
+        delete _state0;
+        delete _state;
+    } else {
+        delete _u_next;
+        delete _psi_next;
+        delete _u0;
+        delete _psi0;
+        delete _u;
+        delete _psi;
+    }
 }
 
 void PureMetal::Simulation::start()
@@ -147,14 +266,22 @@ void PureMetal::Simulation::start()
         if ( std::system ( cmd.c_str() ) == -1 ) {
             throw std::runtime_error ( output_dir_error_msg );
         }
-        _out_visit = new VisitFile ( _out_path, "index", false );
+        if ( _out_writer ) {
+            _out_visit = new VisitFile ( _out_path, "index", false );
+        }
     }
 
     if ( _post_polynomial ) {
-        _post_processors.push_back ( new PolynomialPostProcessor ( _r0, _out_path, "tip_polynomial", false ) );
+        _post_processors.push_back ( new PolynomialPostProcessor ( _r0, _out_path, "tip_polynomial", false, _max_time > 0. ) );
     }
     if ( _post_cspline ) {
-        _post_processors.push_back ( new CSPLinePostProcessor ( _r0, _out_path, "tip_cspline", false ) );
+        _post_processors.push_back ( new CSPLinePostProcessor ( _r0, _out_path, "tip_cspline", false, _max_time > 0. ) );
+    }
+    if ( _narrow_band && _out_writer ) {
+        _band_dat = new DatFile ( _out_path, "narrow_band", false );
+    }
+    if ( _frame_offset > 0. && _out_writer ) {
+        _frame_dat = new DatFile ( _out_path, "moving_frame", false );
     }
 }
 
@@ -173,6 +300,15 @@ void PureMetal::Simulation::start ( const double & delt, const double & steady_s
     start();
 }
 
+// adaptive runs: delt is the first timestep, 0 for the stability limit
+void PureMetal::Simulation::start ( const double & delt, const double & max_time )
+{
+    _max_time = max_time;
+    _controller->start ( delt );
+    _delt = _controller->delt();
+    start();
+}
+
 void PureMetal::Simulation::restart()
 {
     _ts = -_out_interval;
@@ -184,16 +320,55 @@ void PureMetal::Simulation::restart()
     } while ( in_vtk->exists() );
     delete in_vtk;
     if ( _ts > 0 ) {
-        _out_visit = new VisitFile ( _out_path, "index", true );
+        if ( _out_writer ) {
+            _out_visit = new VisitFile ( _out_path, "index", true );
+        }
         _ts -= _out_interval;
         in_vtk = new VtkFile ( _out_path, _ts );
-        in_vtk->read ( _psi, _u );
+        Decomposition * decomposition = _approximation->decomposition();
+        if ( _specs->growth() ) {
+            // the grid had grown to the one saved
+            double size[2] = { 0., 0. };
+            if ( _out_writer ) {
+                unsigned dims[2];
+                in_vtk->size ( dims );
+                size[0] = dims[0];
+                size[1] = dims[1];
+            }
+            if ( decomposition ) {
+                decomposition->broadcast ( size, 2u, 0 );
+            }
+            const unsigned global_size[2] = { static_cast<unsigned> ( size[0] ), static_cast<unsigned> ( size[1] ) };
+            if ( global_size[0] != _approximation->global_size ( 0 ) || global_size[1] != _approximation->global_size ( 1 ) ) {
+                grow ( global_size );
+            }
+        }
+        if ( decomposition ) {
+            Field * psi = nullptr, * u = nullptr;
+            if ( _out_writer ) {
+                psi = _out_approximation->create_field ( 0. );
+                u = _out_approximation->create_field ( 0. );
+                in_vtk->read ( psi, u );
+            }
+            decomposition->scatter ( psi, _psi );
+            decomposition->scatter ( u, _u );
+            delete u;
+            delete psi;
+        } else {
+            in_vtk->read ( _psi, _u );
+        }
 
         if ( _post_polynomial ) {
-            _post_processors.push_back ( new PolynomialPostProcessor ( _r0, _out_path, "tip_polynomial", false ) );
+            _post_processors.push_back ( new PolynomialPostProcessor ( _r0, _out_path, "tip_polynomial", false, _max_time > 0. ) );
         }
         if ( _post_cspline ) {
-            _post_processors.push_back ( new CSPLinePostProcessor ( _r0, _out_path, "tip_cspline", false ) );
+            _post_processors.push_back ( new CSPLinePostProcessor ( _r0, _out_path, "tip_cspline", false, _max_time > 0. ) );
+        }
+        if ( _narrow_band && _out_writer ) {
+            _band_dat = new DatFile ( _out_path, "narrow_band", true );
+        }
+        if ( _frame_offset > 0. && _out_writer ) {
+            _frame_dat = new DatFile ( _out_path, "moving_frame", true );
         }
         delete in_vtk;
     } else {
@@ -217,69 +392,114 @@ void PureMetal::Simulation::restart ( const double & delt, const double & steady
     restart();
 }
 
-void PureMetal::Simulation::next_ts()
+// advances up to the blocking depth timesteps, stopping at output, window and final timesteps; returns how many
+unsigned PureMetal::Simulation::next_ts()
 {
-    _psi0->copy_field ( _psi );
-    _u0->copy_field ( _u );
-    _psix->update ( [ = ] ( unsigned i, unsigned j )-> double {
-        return _psi0->x ( i, j );
-    } );
-    _psiy->update ( [ = ] ( unsigned i, unsigned j )-> double {
-        return _psi0->y ( i, j );
-    } );
-    _n2->update ( [ = ] ( unsigned i, unsigned j )-> double {
-        const double & psix = ( *_psix ) ( i, j );
-        const double & psiy = ( *_psiy ) ( i, j );
-        return psix * psix + psiy * psiy;
-    } );
-    _a->update ( [ = ] ( unsigned i, unsigned j )-> double {
-        const double & psix = ( *_psix ) ( i, j );
-        const double & psiy = ( *_psiy ) ( i, j );
-        const double & n2 = ( *_n2 ) ( i, j );
-        return ( n2 > _tolerance ) ? 1 + _epsilon * ( 4. * ( psix * psix * psix * psix + psiy * psiy * psiy * psiy ) / ( n2 * n2 ) - 3 ) : 1;
-    } );
-    _a2->update ( [ = ] ( unsigned i, unsigned j )-> double {
-        const double & a = ( *_a ) ( i, j );
-        return a * a;
-    } );
-    _bxy->update ( [ = ] ( unsigned i, unsigned j )-> double {
-        const double & psix = ( *_psix ) ( i, j );
-        const double & psiy = ( *_psiy ) ( i, j );
-        const double & n2 = ( *_n2 ) ( i, j );
-        const double & a = ( *_a ) ( i, j );
-        return ( n2 > _tolerance ) ? ( 16.*_epsilon * a * psix * psiy * ( psix * psix - psiy * psiy ) ) / ( n2 * n2 ) : 0;
-    } );
-    Field * Dpsi = _approximation->create_field ( [ = ] ( unsigned i, unsigned j )-> double {
-        const double & psi = ( *_psi0 ) ( i, j );
-        const double & u = ( *_u0 ) ( i, j );
-        const double & a = ( *_a ) ( i, j );
-        const double & a2 = ( *_a2 ) ( i, j );
-        double source = 1. - psi * psi;
-        source *= ( psi - _lambda * u * source );
-        return _delt * (
-            _psi0->laplacian ( i, j ) * a2
-            + ( _a2->x ( i, j ) - _bxy->y ( i, j ) ) * _psi0->x ( i, j )
-            + ( _bxy->x ( i, j ) + _a2->y ( i, j ) ) * _psi0->y ( i, j )
-            + source
-        ) / a2;
-    } );
-    Field * Du = _approximation->create_field ( [ = ] ( unsigned i, unsigned j )-> double {
-        const double & dpsi = ( *Dpsi ) ( i, j );
-        return _delt * _u0->laplacian ( i, j ) * _alpha + dpsi / 2.;
-    } );
-    _psi->add_field ( Dpsi );
-    _u->add_field ( Du );
-    delete Dpsi;
-    delete Du;
+    if ( !_configured ) {
+        // tuning only overwrites psi0 and u0, and psi_next and u_next, which are stale between steps
+        _blocking_depth = _kernel->configure ( _tile_rows, _blocking_depth, _delt, _psi, _u, _psi0, _u0 );
+        if ( _estimator ) {
+            _estimator->configure ( _tile_rows, 1u, _delt, _psi, _u, _psi_next, _u_next );
+        }
+        _configured = true;
+    }
+    unsigned steps = _blocking_depth;
+    if ( _out_interval ) {
+        steps = std::min ( steps, _out_interval - _ts % _out_interval );
+    }
+    if ( _maxts ) {
+        steps = std::min ( steps, _maxts + 1u - _ts );
+    }
+    if ( _threshold > 0 ) {
+        steps = std::min ( steps, _window_size - _ts % _window_size );
+    }
+
+#ifndef NDEBUG
+    const unsigned long allocations = heap_allocations();
+#endif
+    // the current state becomes psi0 and u0, the new one overwrites the previous buffers
+    std::swap ( _psi0, _psi );
+    std::swap ( _u0, _u );
+    _kernel->step ( _delt, steps, _psi0, _u0, _psi, _u );
 
-    ++_ts;
+    _ts += steps;
+#ifndef NDEBUG
+    // runs of an ensemble stepped by pool threads share the count with the other runs
+    assert ( ThreadPool::inside() || heap_allocations() == allocations );
+#endif
+    return steps;
 }
 
+// one timestep of the delt the controller proposes, taken again with the smaller one it proposes next
+// until accepted; the last one is cut to end at max_time. The estimator steps the new psi and u on by
+// the same delt, for the error estimate of the timestep itself ( see TimestepController )
+unsigned PureMetal::Simulation::next_delt()
+{
+    bool last, accepted;
+    do {
+        _delt = _controller->delt();
+        last = ! ( _max_time - _time > _delt );
+        if ( last ) {
+            _delt = _max_time - _time;
+        }
+        next_ts();
+        _estimator->step ( _delt, 1u, _psi, _u, _psi_next, _u_next );
+        accepted = _controller->accept ( _psi0, _u0, _psi, _u, _psi_next, _u_next, _delt, _kernel->max_a2() );
+        if ( !accepted ) {
+            // psi0 and u0 still hold the state to step from
+            std::swap ( _psi0, _psi );
+            std::swap ( _u0, _u );
+            --_ts;
+        }
+    } while ( !accepted );
+    _time = last ? _max_time : _time + _delt;
+    return 1u;
+}
+
+// adaptive runs stop once at max_time, the timestep reaching it having been postprocessed and checked
 bool PureMetal::Simulation::next()
 {
-    next_ts();
+    if ( _max_time > 0. && ! ( _time < _max_time ) ) {
+        return false;
+    }
+    const unsigned steps = _max_time > 0. ? next_delt() : next_ts();
+    if ( _monitor ) {
+        double energy, change;
+        if ( _kernel->divergence ( energy, change ) ) {
+            _monitor->update ( energy, change, steps, _ts );
+        } else {
+            _monitor->update ( _u0, _u, steps, _ts );
+        }
+    }
+    return advance ( steps );
+}
+
+// postprocesses the state reached after steps timesteps; returns whether to go on
+bool PureMetal::Simulation::advance ( const unsigned & steps )
+{
     for ( auto & post_processor : _post_processors ) {
-        post_processor->process ( _approximation, _ts, _psi, _delt );
+        post_processor->process ( _approximation, _ts, time(), _psi, _delt, steps );
+    }
+    if ( _narrow_band ) {
+        // over the whole grid, each rank weighted by its cells
+        double active = _kernel->active_fraction() * _approximation->size ( 0 ) * _approximation->size ( 1 );
+        if ( Decomposition * decomposition = _approximation->decomposition() ) {
+            decomposition->sum ( &active, 1u, 0 );
+        }
+        if ( _band_dat ) {
+            _band_dat->add ( _ts, time(), active / ( static_cast<double> ( _approximation->global_size ( 0 ) ) * _approximation->global_size ( 1 ) ) );
+        }
+    }
+    if ( _frame_offset > 0. ) {
+        // every rank has the tip position, so they all shift together
+        const double passed = post_processor()->tip_position() - _frame_offset;
+        if ( ! ( passed < _approximation->spacing ( 0 ) ) ) {
+            shift_frame ( static_cast<unsigned> ( passed / _approximation->spacing ( 0 ) ) );
+        }
+    }
+    unsigned global_size[2];
+    if ( _specs->growth() && grows ( global_size ) ) {
+        grow ( global_size );
     }
     if ( _maxts ) {
         return _ts <= _maxts;
@@ -290,10 +510,10 @@ bool PureMetal::Simulation::next()
         const double & k2 = post_processor()->tip_k2();
         const double & kpar = post_processor()->tip_kpar();
 
-        _mean_v += v/_window_size;
-        _mean_k1 += k1/_window_size;
-        _mean_k2 += k2/_window_size;
-        _mean_kpar += kpar/_window_size;
+        _mean_v += v*steps/_window_size;
+        _mean_k1 += k1*steps/_window_size;
+        _mean_k2 += k2*steps/_window_size;
+        _mean_kpar += kpar*steps/_window_size;
 
         _steady_state_checkpoint = _ts%_window_size==0;
 
@@ -310,7 +530,7 @@ bool PureMetal::Simulation::next()
             return !steady;
         }
 
-        double x = post_processor()->tip_position(), xm = _approximation->x ( _approximation->size ( 0 ) - 10 );
+        double x = post_processor()->tip_position(), xm = _approximation->x ( _approximation->global_size ( 0 ) - 10 - _approximation->offset ( 0 ) );
         if ( x > xm ) { // too close to boundary !!
             return false;
         }
@@ -318,30 +538,212 @@ bool PureMetal::Simulation::next()
     return true;
 }
 
-void PureMetal::Simulation::save()
+// moves the frame cells cells along x: psi and u are shifted back by as many cells, the inflow taking the
+// far field, and the tip positions with them. Decomposed grids are shifted whole on the writer
+void PureMetal::Simulation::shift_frame ( const unsigned & cells )
 {
-    VtkFile * out_vtk = new VtkFile ( _out_path,  _ts );
-    out_vtk->set_grid ( _approximation->spacing ( 0 ), _approximation->spacing ( 1 ), _approximation->size ( 0 ), _approximation->size ( 1 ), _approximation->x ( 0 ), _approximation->x ( 1 ) );
-    out_vtk->add_time ( _delt * _ts );
-    for ( auto & pair : _out_map ) {
-        out_vtk->add_scalar ( pair.first, pair.second->data() );
+    Field * const fields[2] = { _psi, _u };
+    const double values[2] = { -1., -_delta };
+    Decomposition * decomposition = _approximation->decomposition();
+    for ( unsigned k = 0u; k < 2u; ++k ) {
+        if ( decomposition ) {
+            Field * field = _out_writer ? _out_approximation->create_field ( 0. ) : nullptr;
+            decomposition->gather ( fields[k], field );
+            if ( field ) {
+                field->shift ( cells, values[k] );
+            }
+            decomposition->scatter ( field, fields[k] );
+            delete field;
+        } else {
+            fields[k]->shift ( cells, values[k] );
+        }
+        fields[k]->fill_boundary();
+    }
+    _kernel->invalidate();
+    if ( _estimator ) {
+        _estimator->invalidate();
+    }
+
+    const double dx = cells * _approximation->spacing ( 0 );
+    for ( auto & post_processor : _post_processors ) {
+        post_processor->shift ( dx );
+    }
+    if ( _frame_dat ) {
+        _frame_dat->add ( _ts, time(), dx );
     }
-    out_vtk->save();
-    _out_visit->add ( out_vtk->rel_path() );
-    delete out_vtk;
 }
 
-bool PureMetal::Simulation::stable()
+// whether the grid is to grow ( see Growth ), and into how many cells: along x once the tip is within margin
+// cells of its end, along either direction once u there departs from the far field, within upper
+bool PureMetal::Simulation::grows ( unsigned * global_size ) const
 {
-    for ( unsigned i = 0u; i < _approximation->size ( 0 ); ++i ) {
-        for ( unsigned j = 0u; j < _approximation->size ( 1 ); ++j ) {
-            const double & u = ( *_u ) ( i, j );
-            if ( u + _delta < -_tolerance || u > .5 * _delta ) {
-                return false;
+    const unsigned & Nx = _approximation->size ( 0 );
+    const unsigned & Ny = _approximation->size ( 1 );
+    // at the ends of the grid this rank has
+    double values[2] = { 0., 0. };
+    if ( _approximation->physical ( 1u ) ) {
+        for ( unsigned j = 0u; j < Ny; ++j ) {
+            values[0] = std::max ( values[0], std::abs ( _u->data() [j * _u->stride() + Nx - 1u] + _delta ) );
+        }
+    }
+    if ( _approximation->physical ( 3u ) ) {
+        const double * row = _u->data() + ( Ny - 1u ) * _u->stride();
+        for ( unsigned i = 0u; i < Nx; ++i ) {
+            values[1] = std::max ( values[1], std::abs ( row[i] + _delta ) );
+        }
+    }
+    if ( Decomposition * decomposition = _approximation->decomposition() ) {
+        decomposition->max ( values, 2u );
+    }
+    bool grows = false;
+    for ( unsigned d = 0u; d < 2u; ++d ) {
+        const unsigned & size = _approximation->global_size ( d );
+        bool near = values[d] > _specs->growth_tolerance();
+        if ( d == 0u && postprocesses() ) {
+            near = near || post_processor()->tip_position() > _approximation->spacing ( 0 ) * ( static_cast<double> ( size ) - 1. - _specs->growth_margin() );
+        }
+        const unsigned upper = 1u + static_cast<unsigned> ( std::ceil ( _specs->upper() [d] / _approximation->spacing ( d ) ) );
+        global_size[d] = near ? std::min ( upper, 1u + static_cast<unsigned> ( std::ceil ( _specs->growth_factor() * ( size - 1u ) ) ) ) : size;
+        grows = grows || global_size[d] > size;
+    }
+    return grows;
+}
+
+// grows the grid to global_size cells: psi and u keep their values in the cells they had and take the far
+// field in the others. The kernels and the derived fields are created anew, the kernels being configured
+// again on the next step
+void PureMetal::Simulation::grow ( const unsigned * global_size )
+{
+    Decomposition * decomposition = _approximation->decomposition();
+    const unsigned nx = _approximation->global_size ( 0 ), ny = _approximation->global_size ( 1 );
+    const double values[2] = { -1., -_delta };
+    InterleavedField * const states[3] = { _state, _state0, _state_next };
+    Field * const previous[6] = { _psi, _u, _psi0, _u0, _psi_next, _u_next };
+    // decomposed grids are grown whole on the writer
+    Field * gathered[2] = { nullptr, nullptr };
+    if ( decomposition ) {
+        for ( unsigned k = 0u; k < 2u; ++k ) {
+            gathered[k] = _out_writer ? _out_approximation->create_field ( 0. ) : nullptr;
+            decomposition->gather ( previous[k], gathered[k] );
+        }
+    }
+
+    _approximation->resize ( global_size );
+    if ( _out_approximation ) {
+        _out_approximation->resize ( global_size );
+    }
+    _state = _state0 = _state_next = nullptr;
+    create_state();
+    Field * const fields[2] = { _psi, _u };
+    for ( unsigned k = 0u; k < 2u; ++k ) {
+        if ( decomposition ) {
+            Field * field = _out_writer ? _out_approximation->create_field ( 0. ) : nullptr;
+            if ( field ) {
+                field->extend ( gathered[k], nx, ny, values[k] );
             }
+            decomposition->scatter ( field, fields[k] );
+            delete field;
+            delete gathered[k];
+        } else {
+            fields[k]->extend ( previous[k], nx, ny, values[k] );
         }
+        fields[k]->fill_boundary();
     }
-    return true;
+    if ( states[0] ) {
+        for ( InterleavedField * state : states ) {
+            delete state;
+        }
+    } else {
+        for ( Field * field : previous ) {
+            delete field;
+        }
+    }
+
+    Field ** const derived[6] = { &_psix, &_psiy, &_n2, &_a, &_a2, &_bxy };
+    for ( Field ** field : derived ) {
+        if ( *field ) {
+            delete *field;
+            *field = _approximation->create_field ( 0. );
+        }
+    }
+    delete _kernel;
+    _kernel = create_kernel();
+    if ( _estimator ) {
+        delete _estimator;
+        _estimator = create_kernel();
+    }
+    _configured = false;
 }
 
+void PureMetal::Simulation::save()
+{
+    Decomposition * decomposition = _approximation->decomposition();
+    if ( decomposition ) {
+        // decomposed steps leave the ghosts stale, the derivatives read them
+        _psi->fill_boundary();
+    }
+    if ( _approximation->octant() ) {
+        // steps only reflect the cells below the diagonal they reach: the quadrant is completed for the output
+        for ( Field * field : { _psi, _u } ) {
+            field->reflect_diagonal ( _approximation->size ( 0 ) );
+            field->fill_boundary();
+        }
+    }
+    _kernel->derive ( _psi, _psix, _psiy, _n2, _a, _a2, _bxy );
+    const Approximation * approximation = decomposition ? _out_approximation : _approximation;
+    VtkFile * out_vtk = nullptr;
+    if ( _out_writer ) {
+        out_vtk = new VtkFile ( _out_path,  _ts );
+        out_vtk->set_grid ( approximation->spacing ( 0 ), approximation->spacing ( 1 ), approximation->size ( 0 ), approximation->size ( 1 ), approximation->x ( 0 ), approximation->x ( 1 ) );
+        out_vtk->add_time ( time() );
+    }
+    for ( auto & pair : _out_map ) {
+        if ( decomposition ) {
+            Field * field = _out_writer ? approximation->create_field ( 0. ) : nullptr;
+            decomposition->gather ( *pair.second, field );
+            if ( out_vtk ) {
+                out_vtk->add_scalar ( pair.first, field );
+            }
+            delete field;
+        } else {
+            out_vtk->add_scalar ( pair.first, *pair.second );
+        }
+    }
+    if ( out_vtk ) {
+        out_vtk->save();
+        _out_visit->add ( out_vtk->rel_path() );
+        delete out_vtk;
+    }
+}
 
+// the kernel keeps the bounds of the u it wrote, u is only swept before its first step ( at the start, and
+// after grow() replaced it )
+bool PureMetal::Simulation::stable()
+{
+    double min, max;
+    std::atomic<bool> stable ( true );
+    if ( _kernel->bounds ( min, max ) ) {
+        stable = ! ( min + _delta < -_tolerance || max > .5 * _delta );
+    } else {
+        const unsigned & Nx = _approximation->size ( 0 );
+        _approximation->parallel_tiles ( _approximation->size ( 1 ), [ & ] ( const unsigned & j0, const unsigned & j1, const unsigned & ) {
+            for ( unsigned j = j0; j < j1 && stable; ++j ) {
+                for ( unsigned i = 0u; i < Nx; ++i ) {
+                    const double & u = ( *_u ) ( i, j );
+                    if ( u + _delta < -_tolerance || u > .5 * _delta ) {
+                        stable = false;
+                        break;
+                    }
+                }
+            }
+        } );
+    }
+    if ( _monitor && _monitor->diverged() ) {
+        stable = false;
+    }
+    // every rank must agree to go on
+    if ( Decomposition * decomposition = _approximation->decomposition() ) {
+        return decomposition->all ( stable );
+    }
+    return stable;
+}
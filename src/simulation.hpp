@@ -28,13 +28,25 @@ namespace PureMetal
 {
 
 class Approximation;
+class DatFile;
+class Decomposition;
+class DivergenceMonitor;
 class Field;
+class InterleavedField;
+class Kernel;
 class Specifications;
 class PostProcessor;
+class ThreadPool;
+class TimestepController;
 class VisitFile;
 
 class Simulation
 {
+    // kept for the kernel and the fields, which are created anew when the grid grows
+    const Specifications * _specs;
+    // u is stepped on a grid _coarsening times coarser, 1 for none
+    const unsigned _coarsening;
+
     const double _alpha;
     const double _lambda;
     const double _epsilon;
@@ -48,6 +60,9 @@ class Simulation
     unsigned _maxts;
     unsigned _ts;
     double _threshold;
+    // adaptive runs, whose timesteps vary, keep the time they reached
+    double _time;
+    double _max_time;
 
     bool _steady_state_checkpoint;
     double _mean_v0;
@@ -61,11 +76,24 @@ class Simulation
     unsigned _window_size;
 
     Approximation * _approximation;
+    Approximation * _out_approximation;
+    Kernel * _kernel;
+    Kernel * _estimator;
+    unsigned _tile_rows;
+    unsigned _blocking_depth;
+    bool _configured;
 
+    InterleavedField * _state;
+    InterleavedField * _state0;
     Field * _psi;
     Field * _u;
     Field * _psi0;
     Field * _u0;
+    // adaptive runs: psi and u stepped once more by the estimator for the error estimate, the bounds and
+    // divergence the kernel keeps staying those of the timestep taken
+    InterleavedField * _state_next;
+    Field * _psi_next;
+    Field * _u_next;
     Field * _psix;
     Field * _psiy;
     Field * _n2;
@@ -74,35 +102,64 @@ class Simulation
     Field * _bxy;
 
     std::string _out_path;
+    bool _out_writer;
     unsigned _out_interval;
-    std::map<std::string, const Field *> _out_map;
+    std::map<std::string, Field * const *> _out_map;
     VisitFile * _out_visit;
 
     bool _post_polynomial;
     bool _post_cspline;
     std::list<PostProcessor *> _post_processors;
 
+    DivergenceMonitor * _monitor;
+    TimestepController * _controller;
+
+    bool _narrow_band;
+    DatFile * _band_dat;
+
+    // tip position the frame is moved to keep, 0 without MovingFrame
+    const double _frame_offset;
+    DatFile * _frame_dat;
+
+    Kernel * create_kernel() const;
+    void create_state();
     void start();
     void restart();
-    void next_ts();
+    unsigned next_ts();
+    unsigned next_delt();
+    bool advance ( const unsigned & steps );
+    void shift_frame ( const unsigned & cells );
+    bool grows ( unsigned * global_size ) const;
+    void grow ( const unsigned * global_size );
 
 public:
-    Simulation ( const Specifications * specs );
+    Simulation ( const Specifications * specs, ThreadPool * pool, Decomposition * decomposition );
+    Simulation ( const Specifications * specs, ThreadPool * pool, Decomposition * decomposition, const unsigned & coarsening, const std::string & out_path );
     ~Simulation();
     Simulation ( const Simulation & other ) = delete;
     Simulation & operator= ( const Simulation & other ) = delete;
     bool operator== ( const Simulation & other ) const = delete;
 
     inline const PostProcessor * post_processor() const;
+    inline const DivergenceMonitor * monitor() const;
+    inline const TimestepController * controller() const;
+
+    // the current state
+    inline Field * psi() const;
+    inline Field * u() const;
+    inline const double & delt() const;
+    inline bool postprocesses() const;
 
     void start ( const double & delt, const unsigned & timesteps );
     void start ( const double & delt, const double & steady_state_threshold, const unsigned & window_size );
+    void start ( const double & delt, const double & max_time );
     void restart ( const double & delt, const unsigned & timesteps );
     void restart ( const double & delt, const double & steady_state_threshold, const unsigned & window_size );
     bool next();
     void save();
     bool stable ();
     inline double time();
+    inline const unsigned & timestep() const;
     inline bool save_timestep();
     inline double progress();
     
@@ -124,14 +181,51 @@ const PureMetal::PostProcessor * PureMetal::Simulation::post_processor() const
     return _post_processors.front();
 }
 
+// nullptr without divergence_check
+const PureMetal::DivergenceMonitor * PureMetal::Simulation::monitor() const
+{
+    return _monitor;
+}
+
+// nullptr unless the Time type is adaptive
+const PureMetal::TimestepController * PureMetal::Simulation::controller() const
+{
+    return _controller;
+}
+
+PureMetal::Field * PureMetal::Simulation::psi() const
+{
+    return _psi;
+}
+
+PureMetal::Field * PureMetal::Simulation::u() const
+{
+    return _u;
+}
+
+const double & PureMetal::Simulation::delt() const
+{
+    return _delt;
+}
+
+bool PureMetal::Simulation::postprocesses() const
+{
+    return !_post_processors.empty();
+}
+
 double PureMetal::Simulation::time()
 {
-    return static_cast<double> ( _ts ) * _delt;
+    return _max_time > 0. ? _time : static_cast<double> ( _ts ) * _delt;
+}
+
+const unsigned & PureMetal::Simulation::timestep() const
+{
+    return _ts;
 }
 
 double PureMetal::Simulation::progress()
 {
-    return static_cast<double> ( _ts ) / static_cast<double> ( _maxts );
+    return _max_time > 0. ? _time / _max_time : static_cast<double> ( _ts ) / static_cast<double> ( _maxts );
 }
 
 bool PureMetal::Simulation::save_timestep()
@@ -19,13 +19,32 @@
 
 #include "specifications.hpp"
 
+#include <cstdlib>
+#include <thread>
+#include <utility>
+
 #include <boost/property_tree/xml_parser.hpp>
 
 #include "messages.hpp"
 
+boost::property_tree::ptree PureMetal::Specifications::read ( const std::string & input_file )
+{
+    boost::property_tree::ptree document;
+    boost::property_tree::read_xml ( input_file, document );
+    return document;
+}
+
 PureMetal::Specifications::Specifications ( std::string input_file ) :
+    Specifications ( read ( input_file ) )
+{}
+
+// document is the whole parsed input, as read_xml returns it
+PureMetal::Specifications::Specifications ( const boost::property_tree::ptree & document ) :
     _time_type ( TimeType::undefined ),
     _simulation_type ( SimulationType::undefined ),
+    _precision_report ( false ),
+    _layout ( LayoutType::undefined ),
+    _scheme ( SchemeType::undefined ),
     _alpha ( 0. ),
     _epsilon ( 0. ),
     _delta ( 0. ),
@@ -34,20 +53,42 @@ PureMetal::Specifications::Specifications ( std::string input_file ) :
     _gamma_u ( 0. ),
     _tolerance ( 0. ),
     _stability_check ( false ),
+    _divergence_check ( false ),
+    _divergence_growth ( 0. ),
+    _divergence_window ( 0u ),
     _postprocess_polynomial ( false ),
     _postprocess_cspline ( false ),
+    _narrow_band ( false ),
+    _band_delta ( 0. ),
+    _band_margin ( 0u ),
+    _band_interval ( 0u ),
+    _moving_frame ( false ),
+    _frame_offset ( 0. ),
+    _growth ( false ),
+    _growth_factor ( 0. ),
+    _growth_margin ( 0u ),
+    _growth_tolerance ( 0. ),
+    _coarse_diffusion ( false ),
+    _coarse_factor ( 0u ),
     _delt ( 0. ),
     _max_time ( 0. ),
     _delt_max ( 0. ),
     _delt_min ( 0. ),
     _delt_multiplier ( 0. ),
     _delt_step ( 0. ),
+    _search ( SearchType::undefined ),
+    _delt_tolerance ( 0. ),
+    _candidates ( 0u ),
+    _error_tolerance ( 0. ),
+    _safety ( 0. ),
     _max_timestep ( 0 ),
-    _steady_state_threshold ( 0. )
+    _steady_state_threshold ( 0. ),
+    _threads ( 1u ),
+    _tile_rows ( 0u ),
+    _blocking_depth ( 1u )
 {
     boost::property_tree::ptree tree, subtree;
-    boost::property_tree::read_xml ( input_file, tree );
-    tree = tree.get_child ( "PureMetal_specification" );
+    tree = document.get_child ( "PureMetal_specification" );
 
     // SimulationComponent
     std::string simualtion_type_str = tree.get<std::string> ( "SimulationComponent.<xmlattr>.type" );
@@ -55,6 +96,8 @@ PureMetal::Specifications::Specifications ( std::string input_file ) :
         _simulation_type = SimulationType::full;
     } else if ( simualtion_type_str == "quadrant" ) {
         _simulation_type = SimulationType::quadrant;
+    } else if ( simualtion_type_str == "octant" ) {
+        _simulation_type = SimulationType::octant;
     } else {
         throw std::runtime_error ( unknown_symulation_type_msg + simualtion_type_str );
     }
@@ -70,6 +113,11 @@ PureMetal::Specifications::Specifications ( std::string input_file ) :
     _tolerance = subtree.get ( "tolerance", 1e-6 );
 
     _stability_check = subtree.get ( "stability_check", true );
+    // divergence_check (optional): stability checks also fail once the change in u grows geometrically,
+    // by more than growth per timestep over window timesteps ( see DivergenceMonitor )
+    _divergence_check = subtree.get ( "divergence_check", false );
+    _divergence_growth = subtree.get ( "divergence_check.<xmlattr>.growth", 1.03 );
+    _divergence_window = subtree.get ( "divergence_check.<xmlattr>.window", 5u );
     _postprocess_polynomial = subtree.get ( "postprocess_polynomial", false );
     _postprocess_cspline = subtree.get ( "postprocess_cspline", false );
 
@@ -90,6 +138,10 @@ PureMetal::Specifications::Specifications ( std::string input_file ) :
     }
     std::string spacing_str = subtree.get<std::string> ( "spacing" );
     std::sscanf ( spacing_str.c_str(), "[%lf, %lf]", _spacing, _spacing + 1 );
+    // octant quadrants are stepped above their diagonal and mirrored across it ( see StencilKernel )
+    if ( _simulation_type == SimulationType::octant && ( _upper[0] != _upper[1] || _spacing[0] != _spacing[1] ) ) {
+        throw std::runtime_error ( octant_msg );
+    }
 
     // Time
     subtree = tree.get_child ( "Time" );
@@ -108,10 +160,42 @@ PureMetal::Specifications::Specifications ( std::string input_file ) :
         _time_type = TimeType::stable;
         _delt_max = subtree.get<double> ( "delt_max" );
         _delt_min = subtree.get<double> ( "delt_min" );
-        _delt_multiplier = subtree.get ( "delt_multiplier", 0. );
-        if ( !_delt_multiplier )
-            _delt_step = subtree.get<double> ( "delt_step" );
+        // search (optional): linear walks delt down from delt_max, bisection runs candidates ( default: one
+        // per thread ) concurrently and narrows the bracket around the stability limit down to delt_tolerance
+        std::string search_str = subtree.get ( "search", std::string ( "linear" ) );
+        if ( search_str == "linear" ) {
+            _search = SearchType::linear;
+            _delt_multiplier = subtree.get ( "delt_multiplier", 0. );
+            if ( !_delt_multiplier )
+                _delt_step = subtree.get<double> ( "delt_step" );
+        } else if ( search_str == "bisection" ) {
+            _search = SearchType::bisection;
+            _delt_tolerance = subtree.get<double> ( "delt_tolerance" );
+            _candidates = subtree.get ( "candidates", 0u );
+            if ( ! ( _delt_tolerance > 0. ) ) {
+                throw std::runtime_error ( delt_tolerance_msg );
+            }
+        } else {
+            throw std::runtime_error ( unknown_search_msg + search_str );
+        }
         _max_timestep = subtree.get<unsigned> ( "max_Timesteps" );
+    } else if ( time_type_str == "adaptive" ) {
+        _time_type = TimeType::adaptive;
+        _max_time = subtree.get<double> ( "maxTime" );
+        // each delt keeps the estimated local error of psi and u below error_tolerance and delt below safety
+        // times the explicit stability limit ( see TimestepController ). delt (optional) is the first one, by
+        // default the stability limit; delt_min and delt_max (optional) bound them, 0 leaving them unbounded
+        _error_tolerance = subtree.get<double> ( "error_tolerance" );
+        if ( ! ( _error_tolerance > 0. ) ) {
+            throw std::runtime_error ( error_tolerance_msg );
+        }
+        _safety = subtree.get ( "safety", .9 );
+        if ( ! ( _safety > 0. && _safety <= 1. ) ) {
+            throw std::runtime_error ( safety_msg );
+        }
+        _delt = subtree.get ( "delt", 0. );
+        _delt_min = subtree.get ( "delt_min", 0. );
+        _delt_max = subtree.get ( "delt_max", 0. );
     } else {
         throw std::runtime_error ( unknown_time_type_msg + time_type_str );
     }
@@ -130,6 +214,113 @@ PureMetal::Specifications::Specifications ( std::string input_file ) :
             throw std::runtime_error ( unknown_save_label_msg + label );
         }
     }
+
+    // Layout (optional): separate arrays for psi and u, or one block with their rows interleaved
+    std::string layout_str = tree.get ( "Layout", std::string ( "separate" ) );
+    if ( layout_str == "separate" ) {
+        _layout = LayoutType::separate;
+    } else if ( layout_str == "interleaved" ) {
+        _layout = LayoutType::interleaved;
+    } else {
+        throw std::runtime_error ( unknown_layout_msg + layout_str );
+    }
+
+    // Scheme (optional): explicit Euler steps, or imex ones taking the laplacians of psi and u implicitly
+    // through cosine transforms, which lifts the diffusive bound on delt; imex needs a single rank
+    std::string scheme_str = tree.get ( "Scheme", std::string ( "explicit" ) );
+    if ( scheme_str == "explicit" ) {
+        _scheme = SchemeType::explicit_euler;
+    } else if ( scheme_str == "imex" ) {
+        _scheme = SchemeType::imex;
+    } else {
+        throw std::runtime_error ( unknown_scheme_msg + scheme_str );
+    }
+
+    // NarrowBand (optional): psi and u are only stepped in full in the blocks of cells near the interface,
+    // where |psi| < 1 - delta, widened by margin cells and by the cells the interval timesteps between
+    // updates of the blocks can reach; elsewhere psi is kept and u only diffuses. Explicit scheme only
+    _narrow_band = tree.get ( "NarrowBand", false );
+    _band_delta = tree.get ( "NarrowBand.<xmlattr>.delta", 1e-3 );
+    _band_margin = tree.get ( "NarrowBand.<xmlattr>.margin", 2u );
+    _band_interval = tree.get ( "NarrowBand.<xmlattr>.interval", 8u );
+    if ( _narrow_band && ( ! ( _band_delta > 0. && _band_delta < 1. ) || _band_interval == 0u ) ) {
+        throw std::runtime_error ( narrow_band_msg );
+    }
+    if ( _narrow_band && _scheme == SchemeType::imex ) {
+        throw std::runtime_error ( narrow_band_imex_msg );
+    }
+
+    // the imex solve spans the whole quadrant
+    if ( _simulation_type == SimulationType::octant && _scheme == SchemeType::imex ) {
+        throw std::runtime_error ( octant_msg );
+    }
+
+    // MovingFrame (optional): once the tip passes offset ( default: halfway along x ) by whole cells, psi and u
+    // are shifted back by as many cells, the inflow taking psi = -1 and u = -Delta, so that the tip stays
+    // within a cell of offset; tip positions are relative to the frame, the shifts are recorded in moving_frame
+    _moving_frame = tree.get ( "MovingFrame", false );
+    _frame_offset = tree.get ( "MovingFrame.<xmlattr>.offset", .5 * _upper[0] );
+    if ( _moving_frame && ( _simulation_type != SimulationType::quadrant || ( !_postprocess_polynomial && !_postprocess_cspline )
+                            || ! ( _frame_offset > 0. && _frame_offset < _upper[0] ) ) ) {
+        throw std::runtime_error ( moving_frame_msg );
+    }
+
+    // Growth (optional): quadrant runs start on the grid up to initial ( default: a quarter of upper )
+    // and grow it towards upper, by factor along a direction, once the tip is within margin cells of its end
+    // or u departs there from -Delta by more than tolerance; the cells added take psi = -1 and u = -Delta
+    _growth = tree.get ( "Growth", false );
+    _growth_initial[0] = .25 * _upper[0];
+    _growth_initial[1] = .25 * _upper[1];
+    std::string initial_str = tree.get ( "Growth.<xmlattr>.initial", std::string() );
+    if ( !initial_str.empty() ) {
+        std::sscanf ( initial_str.c_str(), "[%lf, %lf]", _growth_initial, _growth_initial + 1 );
+    }
+    _growth_factor = tree.get ( "Growth.<xmlattr>.factor", 2. );
+    _growth_margin = tree.get ( "Growth.<xmlattr>.margin", 10u );
+    _growth_tolerance = tree.get ( "Growth.<xmlattr>.tolerance", 1e-3 );
+    if ( _growth && ( _simulation_type != SimulationType::quadrant || ! ( _growth_initial[0] > 0. && _growth_initial[0] <= _upper[0] )
+                      || ! ( _growth_initial[1] > 0. && _growth_initial[1] <= _upper[1] ) || ! ( _growth_factor > 1. ) || ! ( _growth_tolerance > 0. ) ) ) {
+        throw std::runtime_error ( growth_msg );
+    }
+
+    // CoarseDiffusion (optional): full and quadrant runs step u on a grid factor ( 2 or 4 ) times coarser,
+    // fed the restriction of ( psi - psi0 ) / 2 and interpolated back for psi ( see CoarseDiffusionKernel );
+    // validate="true" runs a single grid reference alongside and reports the tip errors, only fixed and
+    // steady_state runs
+    _coarse_diffusion = tree.get ( "CoarseDiffusion", false );
+    _coarse_factor = tree.get ( "CoarseDiffusion.<xmlattr>.factor", 2u );
+    // the coarse u is taken back from the nodes it shares with the grid, which frame shifts and growth by
+    // other than whole coarse cells would move
+    if ( _coarse_diffusion && ( ( _coarse_factor != 2u && _coarse_factor != 4u ) || _scheme != SchemeType::explicit_euler || _growth || _moving_frame
+                                || ( _simulation_type != SimulationType::full && _simulation_type != SimulationType::quadrant ) ) ) {
+        throw std::runtime_error ( coarse_diffusion_msg );
+    }
+    _precision_report = _coarse_diffusion && tree.get ( "CoarseDiffusion.<xmlattr>.validate", false );
+    if ( _precision_report && !_postprocess_polynomial && !_postprocess_cspline ) {
+        throw std::runtime_error ( precision_report_postprocess_msg );
+    }
+    // the reference is stepped in lockstep, timestep by timestep, which only fixed and steady_state runs keep
+    if ( _precision_report && _time_type != TimeType::fixed && _time_type != TimeType::steady_state ) {
+        throw std::runtime_error ( precision_report_time_msg );
+    }
+
+    // Parallel (optional): <threads> overrides PUREMETAL_NUM_THREADS, which overrides the number of cores
+    const char * threads_env = std::getenv ( "PUREMETAL_NUM_THREADS" );
+    _threads = threads_env ? std::strtoul ( threads_env, nullptr, 10 ) : std::thread::hardware_concurrency();
+    _threads = tree.get ( "Parallel.threads", _threads );
+    if ( _threads == 0u ) {
+        _threads = 1u;
+    }
+    // <tile_rows> and <blocking_depth> take a number or "auto" ( 0 ) to have them tuned at the first step;
+    // blocked runs step, check and postprocess blocking_depth timesteps at a time
+    for ( auto & setting : { std::make_pair ( "Parallel.tile_rows", &_tile_rows ), std::make_pair ( "Parallel.blocking_depth", &_blocking_depth ) } ) {
+        std::string value_str = tree.get ( setting.first, std::string() );
+        if ( value_str == "auto" ) {
+            *setting.second = 0u;
+        } else if ( !value_str.empty() ) {
+            *setting.second = std::stoul ( value_str );
+        }
+    }
 }
 
 PureMetal::Specifications::~Specifications()
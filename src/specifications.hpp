@@ -23,23 +23,43 @@
 #include <string>
 #include <list>
 
+#include <boost/property_tree/ptree.hpp>
+
 namespace PureMetal
 {
 
 enum class TimeType
 {
-    undefined, fixed, steady_state, stable
+    undefined, fixed, steady_state, stable, adaptive
+};
+
+enum class SearchType
+{
+    undefined, linear, bisection
 };
 
 enum class SimulationType
 {
-    undefined, full, quadrant
+    undefined, full, quadrant, octant
+};
+
+enum class LayoutType
+{
+    undefined, separate, interleaved
+};
+
+enum class SchemeType
+{
+    undefined, explicit_euler, imex
 };
 
 class Specifications
 {
     TimeType _time_type;
     SimulationType _simulation_type;
+    bool _precision_report;
+    LayoutType _layout;
+    SchemeType _scheme;
 
     double _alpha;
     double _epsilon;
@@ -50,9 +70,30 @@ class Specifications
     double _tolerance;
 
     bool _stability_check;
+    bool _divergence_check;
+    double _divergence_growth;
+    unsigned _divergence_window;
     bool _postprocess_polynomial;
     bool _postprocess_cspline;
 
+    bool _narrow_band;
+    double _band_delta;
+    unsigned _band_margin;
+    unsigned _band_interval;
+
+
+    bool _moving_frame;
+    double _frame_offset;
+
+    bool _growth;
+    double _growth_initial[2];
+    double _growth_factor;
+    unsigned _growth_margin;
+    double _growth_tolerance;
+
+    bool _coarse_diffusion;
+    unsigned _coarse_factor;
+
     double _upper[2];
     double _lower [2];
     double _spacing [2];
@@ -62,11 +103,18 @@ class Specifications
     // fixed
     double _max_time;
 
-    // stable
+    // stable and adaptive
     double _delt_max;
     double _delt_min;
     double _delt_multiplier;
     double _delt_step;
+    SearchType _search;
+    double _delt_tolerance;
+    unsigned _candidates;
+
+    // adaptive
+    double _error_tolerance;
+    double _safety;
 
     // steady_state
     unsigned _max_timestep;
@@ -77,16 +125,26 @@ class Specifications
     unsigned _out_interval;
     std::list<std::string> _out_labels;
 
+    unsigned _threads;
+    unsigned _tile_rows;
+    unsigned _blocking_depth;
+
     Specifications ( const Specifications & other ) = delete;
     Specifications & operator= ( const Specifications & other ) = delete;
     bool operator== ( const Specifications & other ) const = delete;
 
+    static boost::property_tree::ptree read ( const std::string & input_file );
+
 public:
     Specifications ( std::string input_file );
+    Specifications ( const boost::property_tree::ptree & document );
     ~Specifications();
 
     inline const TimeType & time_type() const;
     inline const SimulationType & simulation_type() const;
+    inline const bool & precision_report() const;
+    inline const LayoutType & layout() const;
+    inline const SchemeType & scheme() const;
 
     inline const double & alpha() const;
     inline const double & epsilon() const;
@@ -97,9 +155,30 @@ public:
     inline const double & tolerance() const;
 
     inline const bool & stability_check() const;
+    inline const bool & divergence_check() const;
+    inline const double & divergence_growth() const;
+    inline const unsigned & divergence_window() const;
     inline const bool & postprocess_polynomial() const;
     inline const bool & postprocess_cspline() const;
 
+    inline const bool & narrow_band() const;
+    inline const double & band_delta() const;
+    inline const unsigned & band_margin() const;
+    inline const unsigned & band_interval() const;
+
+
+    inline const bool & moving_frame() const;
+    inline const double & frame_offset() const;
+
+    inline const bool & growth() const;
+    inline const double * growth_initial() const;
+    inline const double & growth_factor() const;
+    inline const unsigned & growth_margin() const;
+    inline const double & growth_tolerance() const;
+
+    inline const bool & coarse_diffusion() const;
+    inline const unsigned & coarse_factor() const;
+
     inline const double * upper() const;
     inline const double * lower() const;
     inline const double * spacing() const;
@@ -112,6 +191,12 @@ public:
     inline const double & delt_min() const;
     inline const double & delt_muptiplier() const;
     inline const double & delt_step() const;
+    inline const SearchType & search() const;
+    inline const double & delt_tolerance() const;
+    inline const unsigned & candidates() const;
+
+    inline const double & error_tolerance() const;
+    inline const double & safety() const;
 
     inline const unsigned & max_timestep() const;
     inline const double & steady_state_threshold() const;
@@ -120,6 +205,10 @@ public:
     inline const std::string & out_path() const;
     inline const unsigned & out_interval() const;
     inline const std::list<std::string> & out_labels() const;
+
+    inline const unsigned & threads() const;
+    inline const unsigned & tile_rows() const;
+    inline const unsigned & blocking_depth() const;
 };
 
 }
@@ -134,6 +223,21 @@ const PureMetal::SimulationType & PureMetal::Specifications::simulation_type() c
     return _simulation_type;
 }
 
+const bool & PureMetal::Specifications::precision_report() const
+{
+    return _precision_report;
+}
+
+const PureMetal::LayoutType & PureMetal::Specifications::layout() const
+{
+    return _layout;
+}
+
+const PureMetal::SchemeType & PureMetal::Specifications::scheme() const
+{
+    return _scheme;
+}
+
 const double & PureMetal::Specifications::alpha() const
 {
     return _alpha;
@@ -214,6 +318,31 @@ const double & PureMetal::Specifications::delt_step() const
     return _delt_step;
 }
 
+const PureMetal::SearchType & PureMetal::Specifications::search() const
+{
+    return _search;
+}
+
+const double & PureMetal::Specifications::delt_tolerance() const
+{
+    return _delt_tolerance;
+}
+
+const unsigned & PureMetal::Specifications::candidates() const
+{
+    return _candidates;
+}
+
+const double & PureMetal::Specifications::error_tolerance() const
+{
+    return _error_tolerance;
+}
+
+const double & PureMetal::Specifications::safety() const
+{
+    return _safety;
+}
+
 const unsigned & PureMetal::Specifications::max_timestep() const
 {
     return _max_timestep;
@@ -234,6 +363,21 @@ const bool & PureMetal::Specifications::stability_check() const
     return _stability_check;
 }
 
+const bool & PureMetal::Specifications::divergence_check() const
+{
+    return _divergence_check;
+}
+
+const double & PureMetal::Specifications::divergence_growth() const
+{
+    return _divergence_growth;
+}
+
+const unsigned & PureMetal::Specifications::divergence_window() const
+{
+    return _divergence_window;
+}
+
 const bool & PureMetal::Specifications::postprocess_polynomial() const
 {
     return _postprocess_polynomial;
@@ -244,6 +388,71 @@ const bool & PureMetal::Specifications::postprocess_cspline() const
     return _postprocess_cspline;
 }
 
+const bool & PureMetal::Specifications::narrow_band() const
+{
+    return _narrow_band;
+}
+
+const double & PureMetal::Specifications::band_delta() const
+{
+    return _band_delta;
+}
+
+const unsigned & PureMetal::Specifications::band_margin() const
+{
+    return _band_margin;
+}
+
+const unsigned & PureMetal::Specifications::band_interval() const
+{
+    return _band_interval;
+}
+
+const bool & PureMetal::Specifications::moving_frame() const
+{
+    return _moving_frame;
+}
+
+const double & PureMetal::Specifications::frame_offset() const
+{
+    return _frame_offset;
+}
+
+const bool & PureMetal::Specifications::growth() const
+{
+    return _growth;
+}
+
+const double * PureMetal::Specifications::growth_initial() const
+{
+    return _growth_initial;
+}
+
+const double & PureMetal::Specifications::growth_factor() const
+{
+    return _growth_factor;
+}
+
+const unsigned & PureMetal::Specifications::growth_margin() const
+{
+    return _growth_margin;
+}
+
+const double & PureMetal::Specifications::growth_tolerance() const
+{
+    return _growth_tolerance;
+}
+
+const bool & PureMetal::Specifications::coarse_diffusion() const
+{
+    return _coarse_diffusion;
+}
+
+const unsigned & PureMetal::Specifications::coarse_factor() const
+{
+    return _coarse_factor;
+}
+
 const std::string & PureMetal::Specifications::out_path() const
 {
     return _out_path;
@@ -259,4 +468,19 @@ const std::list< std::string > & PureMetal::Specifications::out_labels() const
     return _out_labels;
 }
 
+const unsigned & PureMetal::Specifications::threads() const
+{
+    return _threads;
+}
+
+const unsigned & PureMetal::Specifications::tile_rows() const
+{
+    return _tile_rows;
+}
+
+const unsigned & PureMetal::Specifications::blocking_depth() const
+{
+    return _blocking_depth;
+}
+
 #endif // PUREMETAL_SPECIFICATIONS_HPP
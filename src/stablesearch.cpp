@@ -0,0 +1,165 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "stablesearch.hpp"
+
+#include <iomanip>
+#include <sstream>
+
+#include "decomposition.hpp"
+#include "messages.hpp"
+#include "simulation.hpp"
+#include "specifications.hpp"
+#include "threadpool.hpp"
+
+PureMetal::StableSearch::StableSearch ( const Specifications * specs, ThreadPool * pool, Decomposition * decomposition )
+    : _specs ( specs ),
+      _pool ( pool ),
+      _decomposition ( decomposition ),
+      _candidates ( specs->candidates() ? specs->candidates() : pool->size() ),
+      _lower ( specs->delt_min() ),
+      _upper ( specs->delt_max() ),
+      _found ( false ),
+      _rounds ( 0u ),
+      _timesteps ( 0ul )
+{
+}
+
+PureMetal::StableSearch::~StableSearch()
+{
+}
+
+// the first round includes delt_max, which closes the bracket when stable, the following ones split the bracket
+bool PureMetal::StableSearch::run ( std::ostream & os )
+{
+    const double & delt_max = _specs->delt_max();
+    const double & delt_min = _specs->delt_min();
+    std::vector<double> delts;
+    for ( unsigned k = 1u; k <= _candidates; ++k ) {
+        delts.push_back ( delt_min + ( delt_max - delt_min ) * k / _candidates );
+    }
+    round ( delts, os );
+    while ( _upper - _lower > _specs->delt_tolerance() ) {
+        delts.clear();
+        for ( unsigned k = 1u; k <= _candidates; ++k ) {
+            delts.push_back ( _lower + ( _upper - _lower ) * k / ( _candidates + 1u ) );
+        }
+        round ( delts, os );
+    }
+    if ( !_found ) {
+        stable_search_error ( os );
+        return false;
+    }
+    stable_search_info ( os, _lower, _upper - _lower, _rounds, _candidates, _timesteps );
+    return true;
+}
+
+// as the single stable run loop, without output to the console
+void PureMetal::StableSearch::advance ( Candidate & candidate ) const
+{
+    Simulation * simulation = candidate.simulation;
+    for ( unsigned n = 0u; n < slice; ++n ) {
+        if ( !simulation->next() ) {
+            candidate.state = State::stable;
+            return;
+        }
+        if ( !simulation->stable() ) {
+            candidate.state = State::unstable;
+            return;
+        }
+        if ( simulation->save_timestep() ) {
+            simulation->save();
+        }
+    }
+}
+
+void PureMetal::StableSearch::round ( const std::vector<double> & delts, std::ostream & os )
+{
+    ++_rounds;
+    std::vector<Candidate> candidates;
+    for ( const double & delt : delts ) {
+        stable_progress_info ( os, delt );
+        Simulation * simulation = new Simulation ( _specs, _pool, _decomposition, _specs->coarse_diffusion() ? _specs->coarse_factor() : 1u, out_path ( _specs, delt ) );
+        simulation->start ( delt, _specs->max_timestep() );
+        if ( _specs->out_interval() ) {
+            simulation->save();
+        }
+        candidates.push_back ( Candidate { delt, simulation, State::running } );
+    }
+    // decomposed candidates exchange halos and agree on stability across ranks, so they take turns
+    const bool concurrent = _decomposition->ranks() == 1;
+    std::vector<Candidate *> live;
+    while ( true ) {
+        live.clear();
+        for ( Candidate & candidate : candidates ) {
+            if ( candidate.state == State::running ) {
+                live.push_back ( &candidate );
+            }
+        }
+        if ( live.empty() ) {
+            break;
+        }
+        if ( concurrent && live.size() >= _pool->size() ) {
+            _pool->parallel_tiles ( live.size(), [ & ] ( const unsigned & k0, const unsigned & k1, const unsigned & ) {
+                for ( unsigned k = k0; k < k1; ++k ) {
+                    advance ( *live[k] );
+                }
+            } );
+        } else {
+            for ( Candidate * candidate : live ) {
+                advance ( *candidate );
+            }
+        }
+        // a stable delt above an unstable one contradicts monotonicity and is not trusted
+        for ( const Candidate & candidate : candidates ) {
+            if ( candidate.state == State::unstable && candidate.simulation ) {
+                stable_rejected_info ( os, candidate.delt, candidate.simulation->timestep() );
+                divergence_info ( os, candidate.simulation->monitor() );
+            }
+            if ( candidate.state == State::unstable && candidate.delt < _upper ) {
+                _upper = candidate.delt;
+            }
+        }
+        for ( const Candidate & candidate : candidates ) {
+            if ( candidate.state == State::stable && candidate.delt <= _upper && ( !_found || candidate.delt > _lower ) ) {
+                _lower = candidate.delt;
+                _found = true;
+            }
+        }
+        for ( Candidate & candidate : candidates ) {
+            if ( candidate.state == State::running && ( candidate.delt > _upper || ( _found && candidate.delt < _lower ) ) ) {
+                candidate.state = State::cancelled;
+                stable_cancelled_info ( os, candidate.delt );
+            }
+            if ( candidate.state != State::running && candidate.simulation ) {
+                _timesteps += candidate.simulation->timestep();
+                delete candidate.simulation;
+                candidate.simulation = nullptr;
+            }
+        }
+    }
+}
+
+std::string PureMetal::StableSearch::out_path ( const Specifications * specs, const double & delt )
+{
+    std::ostringstream path;
+    path << specs->out_path() << "/delt_" << std::scientific << std::setprecision ( 5 ) << delt;
+    return path.str();
+}
@@ -0,0 +1,103 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef PUREMETAL_STABLESEARCH_HPP
+#define PUREMETAL_STABLESEARCH_HPP
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace PureMetal
+{
+
+class Decomposition;
+class Simulation;
+class Specifications;
+class ThreadPool;
+
+// brackets the largest stable delt of a stable run by bisection: each round runs candidates evenly
+// spaced inside the bracket concurrently, one thread per candidate, and cancels those the outcome of the
+// others makes moot ( above an unstable delt or below a stable one ), assuming stability is monotonic in delt
+class StableSearch
+{
+    enum class State {
+        running, stable, unstable, cancelled
+    };
+
+    struct Candidate {
+        double delt;
+        Simulation * simulation;
+        State state;
+    };
+
+    const Specifications * _specs;
+    ThreadPool * _pool;
+    Decomposition * _decomposition;
+    unsigned _candidates;
+    double _lower; // largest delt found stable
+    double _upper; // smallest delt found unstable, or delt_max
+    bool _found;
+    unsigned _rounds;
+    unsigned long _timesteps;
+
+    StableSearch ( const StableSearch & other ) = delete;
+    StableSearch & operator= ( const StableSearch & other ) = delete;
+    bool operator== ( const StableSearch & other ) const = delete;
+
+    void advance ( Candidate & candidate ) const;
+    void round ( const std::vector<double> & delts, std::ostream & os );
+
+public:
+    StableSearch ( const Specifications * specs, ThreadPool * pool, Decomposition * decomposition );
+    ~StableSearch();
+
+    // returns false if no delt above delt_min is stable
+    bool run ( std::ostream & os );
+
+    inline const double & lower() const;
+    inline const double & upper() const;
+    inline const unsigned long & timesteps() const;
+
+    // output of the candidates goes to the filebase directory, in a subdirectory per delt
+    static std::string out_path ( const Specifications * specs, const double & delt );
+
+    // timesteps a live candidate makes before cancellations are decided
+    static const unsigned slice = 10u;
+};
+
+}
+
+const double & PureMetal::StableSearch::lower() const
+{
+    return _lower;
+}
+
+const double & PureMetal::StableSearch::upper() const
+{
+    return _upper;
+}
+
+const unsigned long & PureMetal::StableSearch::timesteps() const
+{
+    return _timesteps;
+}
+
+#endif // PUREMETAL_STABLESEARCH_HPP
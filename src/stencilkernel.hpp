@@ -0,0 +1,873 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PUREMETAL_STENCILKERNEL_HPP
+#define PUREMETAL_STENCILKERNEL_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <limits>
+#include <vector>
+
+#include "decomposition.hpp"
+#include "kernel.hpp"
+#include "field.hpp"
+#include "simd.hpp"
+
+namespace PureMetal
+{
+
+class AnisotropicCell
+{
+    const double _epsilon;
+    const double _tolerance;
+
+public:
+    static constexpr bool isotropic = false;
+
+    inline AnisotropicCell ( const double & epsilon, const double & tolerance );
+
+    inline const double & epsilon() const;
+    inline const double & tolerance() const;
+
+    inline void operator() ( const double & psix, const double & psiy, double & n2, double & a, double & bxy ) const;
+};
+
+class IsotropicCell
+{
+    const double _epsilon;
+    const double _tolerance;
+
+public:
+    static constexpr bool isotropic = true;
+
+    inline IsotropicCell ( const double & tolerance );
+
+    inline const double & epsilon() const;
+    inline const double & tolerance() const;
+
+    inline void operator() ( const double & psix, const double & psiy, double & n2, double & a, double & bxy ) const;
+};
+
+class RectangularSpacing
+{
+    const double _hx;
+    const double _hy;
+
+public:
+    inline RectangularSpacing ( const Approximation * approximation );
+
+    inline const double & x() const;
+    inline const double & y() const;
+};
+
+class SquareSpacing
+{
+    const double _h;
+
+public:
+    inline SquareSpacing ( const Approximation * approximation );
+
+    inline const double & x() const;
+    inline const double & y() const;
+};
+
+template<class ApproximationT, class Boundary, class Cell, class Spacing>
+class StencilKernel : public Kernel
+{
+    StencilKernel ( const StencilKernel & other ) = delete;
+    StencilKernel & operator= ( const StencilKernel & other ) = delete;
+    bool operator== ( const StencilKernel & other ) const = delete;
+
+    const ApproximationT * _approximation;
+    const Cell _cell;
+    const Spacing _spacing;
+    const double _alpha;
+    const double _lambda;
+    const bool _octant;
+
+    const DeriveRow _derive_row;
+    const IncrementRow _increment_row;
+    const unsigned _window_size;
+    double * _windows;
+    unsigned _tile_rows;
+    unsigned _depth;
+    unsigned _tile_size;
+    double * _tiles;
+    double * _bounds;
+    double _band_delta;
+    unsigned _band_margin;
+    unsigned _band_interval;
+    unsigned _band_age;
+    unsigned _band_blocks[2];
+    unsigned char * _band_interface;
+    unsigned char * _band_active;
+    double _active_fraction;
+    // whether steps sum the divergence energy and max | du | too; the energy of each row, summed in row
+    // order once the step is done so that it does not depend on the threads the rows went to; rows whose
+    // pairs with the row before were left to the end of the step, that row having been written by another
+    // call of step_rows
+    bool _watch;
+    double * _energy;
+    unsigned char * _seams;
+    // whether steps leave u to the kernel wrapping this one, single steps only writing psi
+    bool _leave_u;
+
+    void update_band ( const Field * psi0, const unsigned & steps );
+    inline bool band_span ( const int & j, const int & rows, int from, int & begin, int & end ) const;
+    void allocate_tiles ( const unsigned & tile_rows, const unsigned & depth );
+    void step_tile ( const double & delt, const int & depth, const Field * psi0, const Field * u0, Field * psi, Field * u, const int & j0, const int & j1, double * window, double * tile, double * bounds ) const;
+    void step_rows ( const double & delt, const double * psi0, const double * u0, const int & in_first, const int & in_stride, double * psi, double * u, const int & out_first, const int & out_stride, const int & j0, const int & j1, const int & spread, double * window, double * bounds, const double * origin ) const;
+    void seams ( const Field * u0, const Field * u );
+
+public:
+    // rows of psi0 a step reaches beyond the rows it writes
+    static constexpr int reach = Cell::isotropic ? 1 : 2;
+    // cells beyond the diagonal of psi0 a step of octant quadrants reaches beyond those it writes
+    static constexpr int diagonal_reach = Cell::isotropic ? 1 : 3;
+    // cells per side of the blocks narrow bands are made of
+    static constexpr int band_block = 16;
+
+    StencilKernel ( const ApproximationT * approximation, const Cell & cell, const double & alpha, const double & lambda );
+    inline ~StencilKernel();
+
+    unsigned configure ( const unsigned & tile_rows, const unsigned & depth, const double & delt, Field * psi0, Field * u0, Field * psi, Field * u ) override;
+    void step ( const double & delt, const unsigned & steps, Field * psi0, Field * u0, Field * psi, Field * u ) override;
+    inline bool bounds ( double & min, double & max ) const override;
+    inline double max_a2() const override;
+    void narrow_band ( const double & delta, const unsigned & margin, const unsigned & interval ) override;
+    inline double active_fraction() const override;
+    inline void invalidate() override;
+    inline void watch_divergence() override;
+    inline bool divergence ( double & energy, double & change ) const override;
+    inline bool leave_u() override;
+    void derive ( const Field * psi, Field * psix, Field * psiy, Field * n2, Field * a, Field * a2, Field * bxy ) const override;
+};
+
+}
+
+PureMetal::AnisotropicCell::AnisotropicCell ( const double & epsilon, const double & tolerance )
+    : _epsilon ( epsilon ),
+      _tolerance ( tolerance )
+{}
+
+const double & PureMetal::AnisotropicCell::epsilon() const
+{
+    return _epsilon;
+}
+
+const double & PureMetal::AnisotropicCell::tolerance() const
+{
+    return _tolerance;
+}
+
+void PureMetal::AnisotropicCell::operator() ( const double & psix, const double & psiy, double & n2, double & a, double & bxy ) const
+{
+    n2 = psix * psix + psiy * psiy;
+    a = ( n2 > _tolerance ) ? 1 + _epsilon * ( 4. * ( psix * psix * psix * psix + psiy * psiy * psiy * psiy ) / ( n2 * n2 ) - 3 ) : 1;
+    bxy = ( n2 > _tolerance ) ? ( 16.*_epsilon * a * psix * psiy * ( psix * psix - psiy * psiy ) ) / ( n2 * n2 ) : 0;
+}
+
+PureMetal::IsotropicCell::IsotropicCell ( const double & tolerance )
+    : _epsilon ( 0. ),
+      _tolerance ( tolerance )
+{}
+
+const double & PureMetal::IsotropicCell::epsilon() const
+{
+    return _epsilon;
+}
+
+const double & PureMetal::IsotropicCell::tolerance() const
+{
+    return _tolerance;
+}
+
+// epsilon == 0: A == 1 and Bxy == 0 everywhere
+void PureMetal::IsotropicCell::operator() ( const double & psix, const double & psiy, double & n2, double & a, double & bxy ) const
+{
+    n2 = psix * psix + psiy * psiy;
+    a = 1.;
+    bxy = 0.;
+}
+
+PureMetal::RectangularSpacing::RectangularSpacing ( const Approximation * approximation )
+    : _hx ( approximation->spacing ( 0 ) ),
+      _hy ( approximation->spacing ( 1 ) )
+{}
+
+const double & PureMetal::RectangularSpacing::x() const
+{
+    return _hx;
+}
+
+const double & PureMetal::RectangularSpacing::y() const
+{
+    return _hy;
+}
+
+PureMetal::SquareSpacing::SquareSpacing ( const Approximation * approximation )
+    : _h ( approximation->spacing ( 0 ) )
+{}
+
+const double & PureMetal::SquareSpacing::x() const
+{
+    return _h;
+}
+
+const double & PureMetal::SquareSpacing::y() const
+{
+    return _h;
+}
+
+template<class ApproximationT, class Boundary, class Cell, class Spacing>
+PureMetal::StencilKernel<ApproximationT, Boundary, Cell, Spacing>::StencilKernel ( const ApproximationT * approximation, const Cell & cell, const double & alpha, const double & lambda )
+    : Kernel(),
+      _approximation ( approximation ),
+      _cell ( cell ),
+      _spacing ( approximation ),
+      _alpha ( alpha ),
+      _lambda ( lambda ),
+      _octant ( approximation->octant() ),
+      _derive_row ( Cell::isotropic ? nullptr : derive_row ( simd_type() ) ),
+      _increment_row ( Cell::isotropic ? nullptr : increment_row ( simd_type() ) ),
+      _window_size ( Cell::isotropic ? 0u : 12u * ( approximation->size ( 0 ) + 2u * PUREMETAL_HALO ) ),
+      _windows ( Cell::isotropic ? nullptr : new double[approximation->threads() * _window_size] ),
+      _tile_rows ( 0u ),
+      _depth ( 1u ),
+      _tile_size ( 0u ),
+      _tiles ( nullptr ),
+      _bounds ( new double[4u * approximation->threads()] ),
+      _band_delta ( 0. ),
+      _band_margin ( 0u ),
+      _band_interval ( 0u ),
+      _band_age ( 0u ),
+      _band_blocks { ( approximation->size ( 0 ) + band_block - 1u ) / band_block, ( approximation->size ( 1 ) + band_block - 1u ) / band_block },
+      _band_interface ( nullptr ),
+      _band_active ( nullptr ),
+      _active_fraction ( 1. ),
+      _watch ( false ),
+      _energy ( new double[approximation->size ( 1 )] ),
+      _seams ( new unsigned char[approximation->size ( 1 )] ),
+      _leave_u ( false )
+{
+    std::fill ( _energy, _energy + approximation->size ( 1 ), 0. );
+    std::fill ( _seams, _seams + approximation->size ( 1 ), 0u );
+    std::fill ( _bounds, _bounds + 4u * approximation->threads(), 0. );
+    // no step has written u yet, bounds() reports none until one does
+    for ( unsigned thread = 0u; thread < approximation->threads(); ++thread ) {
+        _bounds[4u * thread] = _bounds[4u * thread + 1u] = std::numeric_limits<double>::quiet_NaN();
+    }
+}
+
+template<class ApproximationT, class Boundary, class Cell, class Spacing>
+PureMetal::StencilKernel<ApproximationT, Boundary, Cell, Spacing>::~StencilKernel()
+{
+    delete [] _seams;
+    delete [] _energy;
+    delete [] _band_active;
+    delete [] _band_interface;
+    delete [] _bounds;
+    delete [] _tiles;
+    delete [] _windows;
+}
+
+// the interface blocks, those with cells where |psi0| < 1 - delta, are scanned again once the active ones
+// have served interval timesteps. psi only changes in active blocks, so only they can have gained or lost
+// interface cells. Active blocks are within the margin of an interface block, widened by the cells that
+// the timesteps until the next scan reach ( interval, or steps when blocked steps take more ). Octant
+// quadrants scan the cells above the diagonal, the blocks below it taking the interface of their images
+template<class ApproximationT, class Boundary, class Cell, class Spacing>
+void PureMetal::StencilKernel<ApproximationT, Boundary, Cell, Spacing>::update_band ( const Field * psi0, const unsigned & steps )
+{
+    if ( _band_age + steps <= _band_interval ) {
+        _band_age += steps;
+        return;
+    }
+    const int & Nx = _approximation->size ( 0 );
+    const int & Ny = _approximation->size ( 1 );
+    const int nbx = _band_blocks[0], nby = _band_blocks[1];
+    const double limit = 1. - _band_delta;
+    _approximation->parallel_for ( nby, [ & ] ( const unsigned & b0, const unsigned & b1, const unsigned & ) {
+        for ( int by = b0; by < static_cast<int> ( b1 ); ++by ) {
+            for ( int bx = 0; bx < nbx; ++bx ) {
+                unsigned char & interface = _band_interface[by * nbx + bx];
+                if ( !_band_active[by * nbx + bx] ) {
+                    continue;
+                }
+                interface = 0u;
+                for ( int j = by * band_block; j < std::min ( Ny, ( by + 1 ) * band_block ) && !interface; ++j ) {
+                    const double * p = psi0->data() + j * psi0->stride();
+                    for ( int i = bx * band_block; i < std::min ( _octant ? j + 1 : Nx, ( bx + 1 ) * band_block ); ++i ) {
+                        interface |= std::abs ( p[i] ) < limit;
+                    }
+                }
+            }
+        }
+    } );
+    if ( _octant ) {
+        for ( int by = 0; by < nby; ++by ) {
+            for ( int bx = by + 1; bx < nbx; ++bx ) {
+                _band_interface[by * nbx + bx] = _band_interface[bx * nbx + by];
+            }
+        }
+    }
+    const int cells = _band_margin + reach * std::max ( _band_interval, steps );
+    const int d = ( cells + band_block - 1 ) / band_block;
+    unsigned long active = 0u;
+    for ( int by = 0; by < nby; ++by ) {
+        for ( int bx = 0; bx < nbx; ++bx ) {
+            unsigned char near = 0u;
+            for ( int ny = std::max ( 0, by - d ); ny < std::min ( nby, by + d + 1 ) && !near; ++ny ) {
+                for ( int nx = std::max ( 0, bx - d ); nx < std::min ( nbx, bx + d + 1 ); ++nx ) {
+                    near |= _band_interface[ny * nbx + nx];
+                }
+            }
+            _band_active[by * nbx + bx] = near;
+            if ( near ) {
+                active += ( std::min ( Nx, ( bx + 1 ) * band_block ) - bx * band_block ) * ( std::min ( Ny, ( by + 1 ) * band_block ) - by * band_block );
+            }
+        }
+    }
+    _active_fraction = static_cast<double> ( active ) / ( static_cast<double> ( Nx ) * Ny );
+    _band_age = steps;
+}
+
+// the next run [begin,end) of columns from from on that row j steps in full, rows 0, or derives, rows 1:
+// those of the active blocks over rows j - rows to j + rows, widened by rows cells. These rows, clamped
+// to the grid, span at most two block rows; without narrow band the run is the rest of the row
+template<class ApproximationT, class Boundary, class Cell, class Spacing>
+bool PureMetal::StencilKernel<ApproximationT, Boundary, Cell, Spacing>::band_span ( const int & j, const int & rows, int from, int & begin, int & end ) const
+{
+    const int & Nx = _approximation->size ( 0 );
+    const int & Ny = _approximation->size ( 1 );
+    if ( from >= Nx ) {
+        return false;
+    }
+    if ( !_band_active ) {
+        begin = from;
+        end = Nx;
+        return true;
+    }
+    const int nbx = _band_blocks[0];
+    const int r0 = std::max ( 0, std::min ( j - rows, Ny - 1 ) ) / band_block, r1 = std::max ( 0, std::min ( j + rows, Ny - 1 ) ) / band_block;
+    auto active = [ & ] ( const int & bx ) {
+        return _band_active[r0 * nbx + bx] || _band_active[r1 * nbx + bx];
+    };
+    // blocks before this one end, widened, before from
+    int bx = std::max ( 0, from - rows ) / band_block;
+    while ( bx < nbx && !active ( bx ) ) {
+        ++bx;
+    }
+    if ( bx == nbx ) {
+        return false;
+    }
+    begin = std::max ( from, bx * band_block - rows );
+    while ( bx < nbx && active ( bx ) ) {
+        ++bx;
+    }
+    end = std::min ( Nx, bx * band_block + rows );
+    return true;
+}
+
+// per thread, a tile keeps two intermediate levels of psi and u over the tile rows,
+// the rows they reach and one ghost row on each side
+template<class ApproximationT, class Boundary, class Cell, class Spacing>
+void PureMetal::StencilKernel<ApproximationT, Boundary, Cell, Spacing>::allocate_tiles ( const unsigned & tile_rows, const unsigned & depth )
+{
+    delete [] _tiles;
+    _tile_rows = tile_rows;
+    _depth = depth;
+    _tile_size = depth > 1u ? 4u * ( tile_rows + 2u * reach * ( depth - 1u ) + 2u ) * ( _approximation->size ( 0 ) + 2u * PUREMETAL_HALO ) : 0u;
+    _tiles = _tile_size ? new double[_approximation->threads() * _tile_size] : nullptr;
+}
+
+// fixes tile rows and blocking depth, values of 0 are tuned by timing one block of
+// each candidate from psi0 and u0 into psi and u
+template<class ApproximationT, class Boundary, class Cell, class Spacing>
+unsigned PureMetal::StencilKernel<ApproximationT, Boundary, Cell, Spacing>::configure ( const unsigned & tile_rows, const unsigned & depth, const double & delt, Field * psi0, Field * u0, Field * psi, Field * u )
+{
+    const unsigned & Ny = _approximation->size ( 1 );
+    // blocks would need ghost layers as deep as they reach, decomposed grids step one timestep at a time
+    if ( _approximation->decomposition() ) {
+        allocate_tiles ( Ny, 1u );
+        return _depth;
+    }
+    std::vector<unsigned> depths, rows;
+    if ( depth ) {
+        depths.push_back ( depth );
+    } else {
+        depths = { 1u, 2u, 4u, 8u };
+    }
+    if ( tile_rows ) {
+        rows.push_back ( tile_rows );
+    } else {
+        for ( unsigned r = 16u; r < 4u * Ny && r <= 256u; r *= 4u ) {
+            rows.push_back ( std::min ( r, Ny ) );
+        }
+        if ( rows.empty() ) {
+            rows.push_back ( Ny );
+        }
+    }
+
+    if ( depth == 1u || ( depths.size() == 1u && rows.size() == 1u ) ) {
+        allocate_tiles ( rows[0], depths[0] );
+        return _depth;
+    }
+
+    unsigned best_rows = rows[0], best_depth = depths[0];
+    double best = std::numeric_limits<double>::infinity();
+    for ( const unsigned & d : depths ) {
+        for ( const unsigned & r : rows ) {
+            allocate_tiles ( r, d );
+            const auto start = std::chrono::steady_clock::now();
+            step ( delt, d, psi0, u0, psi, u );
+            const double elapsed = std::chrono::duration<double> ( std::chrono::steady_clock::now() - start ).count() / d;
+            if ( elapsed < best ) {
+                best = elapsed;
+                best_rows = r;
+                best_depth = d;
+            }
+            if ( d == 1u ) {
+                break; // rows do not matter without blocking
+            }
+        }
+    }
+    allocate_tiles ( best_rows, best_depth );
+    return _depth;
+}
+
+template<class ApproximationT, class Boundary, class Cell, class Spacing>
+void PureMetal::StencilKernel<ApproximationT, Boundary, Cell, Spacing>::step ( const double & delt, const unsigned & steps, Field * psi0_field, Field * u0_field, Field * psi_field, Field * u_field )
+{
+    const unsigned & Ny = _approximation->size ( 1 );
+    if ( _band_active ) {
+        update_band ( psi0_field, steps );
+    }
+    // each thread keeps the bounds of the u it writes and the largest a2 it steps with, as min, max, a2,
+    // then the max | du | of the divergence monitor when watched
+    for ( unsigned thread = 0u; thread < _approximation->threads(); ++thread ) {
+        _bounds[4u * thread] = std::numeric_limits<double>::infinity();
+        _bounds[4u * thread + 1u] = -std::numeric_limits<double>::infinity();
+        _bounds[4u * thread + 2u] = Cell::isotropic ? 1. : 0.;
+        _bounds[4u * thread + 3u] = 0.;
+    }
+    const double * origin = _watch ? u0_field->data() : nullptr;
+    if ( Decomposition * decomposition = _approximation->decomposition() ) {
+        // ghost rows travel while the rows that do not reach them are computed
+        Field * const fields[2] = { psi0_field, u0_field };
+        decomposition->exchange_columns ( fields, 2u );
+        decomposition->start_rows ( fields, 2u );
+        _approximation->parallel_tiles ( Ny - 2u * reach, [ & ] ( const unsigned & j0, const unsigned & j1, const unsigned & thread ) {
+            step_rows ( delt, psi0_field->data(), u0_field->data(), 0, psi0_field->stride(), psi_field->data(), u_field->data(), 0, psi_field->stride(), reach + j0, reach + j1, 0, _windows + thread * _window_size, _bounds + 4u * thread, origin );
+        } );
+        decomposition->finish_rows ( fields, 2u );
+        for ( const int & j0 : { 0, static_cast<int> ( Ny ) - reach } ) {
+            step_rows ( delt, psi0_field->data(), u0_field->data(), 0, psi0_field->stride(), psi_field->data(), u_field->data(), 0, psi_field->stride(), j0, j0 + reach, 0, _windows, _bounds, origin );
+        }
+        seams ( u0_field, u_field );
+        return;
+    }
+    if ( steps == 1u ) {
+        // rows are independent given psi0 and u0: results do not depend on the partition,
+        // each thread rolls its own window over the rows it takes
+        _approximation->parallel_tiles ( Ny, [ & ] ( const unsigned & j0, const unsigned & j1, const unsigned & thread ) {
+            step_rows ( delt, psi0_field->data(), u0_field->data(), 0, psi0_field->stride(), psi_field->data(), u_field->data(), 0, psi_field->stride(), j0, j1, 0, _windows + thread * _window_size, _bounds + 4u * thread, origin );
+        } );
+    } else {
+        // tiles overlap at intermediate levels and are recomputed by each of them, so they stay independent too
+        const unsigned tiles = ( Ny + _tile_rows - 1u ) / _tile_rows;
+        _approximation->parallel_tiles ( tiles, [ & ] ( const unsigned & t0, const unsigned & t1, const unsigned & thread ) {
+            for ( unsigned t = t0; t < t1; ++t ) {
+                step_tile ( delt, steps, psi0_field, u0_field, psi_field, u_field, t * _tile_rows, std::min ( ( t + 1u ) * _tile_rows, Ny ),
+                            _windows + thread * _window_size, _tiles + thread * _tile_size, _bounds + 4u * thread );
+            }
+        } );
+    }
+    seams ( u0_field, u_field );
+    // of octant quadrants, the cells below the diagonal that the next steps reach
+    if ( _octant ) {
+        psi_field->reflect_diagonal ( diagonal_reach * std::max ( _depth, steps ) );
+        if ( !_leave_u ) {
+            u_field->reflect_diagonal ( diagonal_reach * std::max ( _depth, steps ) );
+        }
+    }
+    psi_field->fill_boundary();
+    if ( !_leave_u ) {
+        u_field->fill_boundary();
+    }
+}
+
+// advances rows [j0,j1) by depth steps: level t is computed over the rows that levels t+1..depth reach,
+// intermediate levels live in the tile and only the last one is written to psi and u. On octant quadrants
+// they also spread beyond the diagonal by the cells that levels t+1..depth reach
+template<class ApproximationT, class Boundary, class Cell, class Spacing>
+void PureMetal::StencilKernel<ApproximationT, Boundary, Cell, Spacing>::step_tile ( const double & delt, const int & depth, const Field * psi0_field, const Field * u0_field, Field * psi_field, Field * u_field, const int & j0, const int & j1, double * window, double * tile, double * bounds ) const
+{
+    const int & Nx = _approximation->size ( 0 );
+    const int & Ny = _approximation->size ( 1 );
+    const int stride = Nx + 2 * PUREMETAL_HALO;
+    const int first = j0 - reach * ( depth - 1 ) - 1;
+    const int level_size = ( j1 - j0 + 2 * reach * ( depth - 1 ) + 2 ) * stride;
+
+    const double * psi0 = psi0_field->data(), * u0 = u0_field->data();
+    int in_first = 0, in_stride = psi0_field->stride();
+    for ( int t = 1; t < depth; ++t ) {
+        double * psi = tile + ( 2 * ( t % 2 ) ) * level_size + PUREMETAL_HALO;
+        double * u = psi + level_size;
+        const int a = std::max ( 0, j0 - reach * ( depth - t ) ), b = std::min ( Ny, j1 + reach * ( depth - t ) );
+        step_rows ( delt, psi0, u0, in_first, in_stride, psi, u, first, stride, a, b, diagonal_reach * ( depth - t ), window, nullptr, nullptr );
+        for ( int j = a; j < b; ++j ) {
+            Boundary::fill ( psi + ( j - first ) * stride, Nx, PUREMETAL_HALO );
+            Boundary::fill ( u + ( j - first ) * stride, Nx, PUREMETAL_HALO );
+        }
+        for ( const int & j : { -1, Ny } ) {
+            if ( j == a - 1 || j == b ) {
+                const int k = Boundary::index ( j, Ny );
+                std::copy ( psi + ( k - first ) * stride - PUREMETAL_HALO, psi + ( k - first + 1 ) * stride - PUREMETAL_HALO, psi + ( j - first ) * stride - PUREMETAL_HALO );
+                std::copy ( u + ( k - first ) * stride - PUREMETAL_HALO, u + ( k - first + 1 ) * stride - PUREMETAL_HALO, u + ( j - first ) * stride - PUREMETAL_HALO );
+            }
+        }
+        psi0 = psi;
+        u0 = u;
+        in_first = first;
+        in_stride = stride;
+    }
+    step_rows ( delt, psi0, u0, in_first, in_stride, psi_field->data(), u_field->data(), 0, psi_field->stride(), j0, j1, 0, window, bounds, _watch ? u0_field->data() : nullptr );
+}
+
+// writes rows [j0,j1) of psi and u from psi0 and u0: row j of the inputs starts at ( j - in_first ) * in_stride,
+// of the outputs at ( j - out_first ) * out_stride. Bounds, unless nullptr, are widened to the u written
+// and the a2 it was stepped with, each row being scanned while still in cache. Given origin, the rows of
+// u0 laid out as those of u, the divergence energy ( see DivergenceMonitor ) of each row written is kept and
+// the bounds widened to its max | du |, the pairs of row j0 with the row before being left to seams. Octant quadrants
+// only write the cells of row j up to spread beyond the diagonal, i <= j + spread, and psi0 must hold
+// those diagonal_reach further. Kernels leaving u to their wrapper write psi alone, u0 only feeding the source
+template<class ApproximationT, class Boundary, class Cell, class Spacing>
+void PureMetal::StencilKernel<ApproximationT, Boundary, Cell, Spacing>::step_rows ( const double & delt, const double * psi0, const double * u0, const int & in_first, const int & in_stride, double * psi, double * u, const int & out_first, const int & out_stride, const int & j0, const int & j1, const int & spread, double * window, double * bounds, const double * origin ) const
+{
+    const int & Nx = _approximation->size ( 0 );
+    const int & Ny = _approximation->size ( 1 );
+    const double & hx = _spacing.x();
+    const double & hy = _spacing.y();
+    const int stride = Nx + 2 * PUREMETAL_HALO;
+
+    // rolling window over three rows of the derived fields: row r is kept in slot r % 3,
+    // each row framed by ghost cells as the fields themselves
+    const StencilCoefficients c = { hx, hy, _cell.epsilon(), _cell.tolerance(), _alpha, _lambda, delt };
+    double * psix[3], * psiy[3], * a2[3], * bxy[3];
+    for ( int s = 0; s < 3; ++s ) {
+        psix[s] = window + ( 4 * s ) * stride + PUREMETAL_HALO;
+        psiy[s] = window + ( 4 * s + 1 ) * stride + PUREMETAL_HALO;
+        a2[s] = window + ( 4 * s + 2 ) * stride + PUREMETAL_HALO;
+        bxy[s] = window + ( 4 * s + 3 ) * stride + PUREMETAL_HALO;
+    }
+
+    // next to a neighbouring block ( decomposed grids ) the rows -1 and Ny and the cells -1 and Nx
+    // are derived from its ghosts instead of being mirrored
+    const bool west = _approximation->physical ( 0u ), east = _approximation->physical ( 1u );
+    const bool south = _approximation->physical ( 2u ), north = _approximation->physical ( 3u );
+    auto slot = [] ( const int & r ) {
+        return ( r + 3 ) % 3;
+    };
+    // end of the cells of row r written, or derived two cells further for the rows next to it
+    auto row_end = [ & ] ( const int & r, const int & cells ) {
+        return _octant ? std::max ( 0, std::min ( Nx, r + 1 + spread + cells ) ) : Nx;
+    };
+    auto derive_cell = [ & ] ( const double * p, const int & s, const int & i ) {
+        const double x = ( p[i + 1] - p[i - 1] ) / ( 2.*hx );
+        const double y = ( p[i + in_stride] - p[i - in_stride] ) / ( 2.*hy );
+        double n2, a, b;
+        _cell ( x, y, n2, a, b );
+        psix[s][i] = x;
+        psiy[s][i] = y;
+        a2[s][i] = a * a;
+        bxy[s][i] = b;
+    };
+    auto derive_row = [ & ] ( const int & r ) {
+        const int s = slot ( r );
+        const double * p = psi0 + ( r - in_first ) * in_stride;
+        const int end = row_end ( r, 2 );
+        for ( int a = 0, b = 0; band_span ( r, 1, b, a, b ) && a < end; ) {
+            b = std::min ( b, end );
+            for ( int i = a + ( _derive_row ? _derive_row ( p + a, in_stride, b - a, c, psix[s] + a, psiy[s] + a, a2[s] + a, bxy[s] + a ) : 0 ); i < b; ++i ) {
+                derive_cell ( p, s, i );
+            }
+        }
+        Boundary::fill ( a2[s], Nx, PUREMETAL_HALO );
+        Boundary::fill ( bxy[s], Nx, PUREMETAL_HALO );
+        if ( !west ) {
+            derive_cell ( p, s, -1 );
+        }
+        if ( !east ) {
+            derive_cell ( p, s, Nx );
+        }
+    };
+
+    if ( !Cell::isotropic ) {
+        if ( j0 > 0 || !south ) {
+            derive_row ( j0 - 1 );
+        }
+        derive_row ( j0 );
+    }
+    for ( int j = j0; j < j1; ++j ) {
+        if ( !Cell::isotropic && ( j + 1 < Ny || !north ) ) {
+            derive_row ( j + 1 );
+        }
+        const int s = slot ( j ), sm = slot ( south ? Boundary::index ( j - 1, Ny ) : j - 1 ), sp = slot ( north ? Boundary::index ( j + 1, Ny ) : j + 1 );
+        const double * p = psi0 + ( j - in_first ) * in_stride;
+        const double * v = u0 + ( j - in_first ) * in_stride;
+        double * psij = psi + ( j - out_first ) * out_stride, * uj = _leave_u ? nullptr : u + ( j - out_first ) * out_stride;
+        // cells between the runs stepped in full keep psi and only diffuse u
+        const int end = row_end ( j, 0 );
+        for ( int from = 0, a = 0, b = 0; from < end; from = b ) {
+            if ( !band_span ( j, 0, from, a, b ) ) {
+                a = b = Nx;
+            }
+            a = std::min ( a, end );
+            b = std::min ( b, end );
+            std::copy ( p + from, p + a, psij + from );
+            if ( uj ) {
+                for ( int i = from; i < a; ++i ) {
+                    const double lap_u = ( v[i + 1] + v[i - 1] - 2 * v[i] ) / hx + ( v[i + in_stride] + v[i - in_stride] - 2 * v[i] ) / hy;
+                    uj[i] = v[i] + delt * lap_u * _alpha;
+                }
+            }
+            if ( bounds && uj ) {
+                double min = bounds[0], max = bounds[1];
+                for ( int i = from; i < a; ++i ) {
+                    min = uj[i] < min ? uj[i] : min;
+                    max = uj[i] > max ? uj[i] : max;
+                }
+                bounds[0] = min;
+                bounds[1] = max;
+            }
+            if ( a == b ) {
+                continue;
+            }
+            const double * a2_rows[3] = { a2[sm] + a, a2[s] + a, a2[sp] + a }, * bxy_rows[3] = { bxy[sm] + a, bxy[s] + a, bxy[sp] + a };
+            const int done = a + ( _increment_row ? _increment_row ( p + a, v + a, in_stride, b - a, c, psix[s] + a, psiy[s] + a, a2_rows, bxy_rows, psij + a, uj ? uj + a : nullptr, bounds ) : 0 );
+            for ( int i = done; i < b; ++i ) {
+                double source = 1. - p[i] * p[i];
+                source *= ( p[i] - _lambda * v[i] * source );
+                const double lap_psi = ( p[i + 1] + p[i - 1] - 2 * p[i] ) / hx + ( p[i + in_stride] + p[i - in_stride] - 2 * p[i] ) / hy;
+                double dpsi;
+                if ( Cell::isotropic ) {
+                    dpsi = delt * ( lap_psi + source );
+                } else {
+                    const double & a2c = a2[s][i];
+                    const double a2x = ( a2[s][i + 1] - a2[s][i - 1] ) / ( 2.*hx );
+                    const double a2y = ( a2[sp][i] - a2[sm][i] ) / ( 2.*hy );
+                    const double bxyx = ( bxy[s][i + 1] - bxy[s][i - 1] ) / ( 2.*hx );
+                    const double bxyy = ( bxy[sp][i] - bxy[sm][i] ) / ( 2.*hy );
+                    dpsi = delt * (
+                               lap_psi * a2c
+                               + ( a2x - bxyy ) * psix[s][i]
+                               + ( bxyx + a2y ) * psiy[s][i]
+                               + source
+                           ) / a2c;
+                }
+                psij[i] = p[i] + dpsi;
+                if ( uj ) {
+                    const double lap_u = ( v[i + 1] + v[i - 1] - 2 * v[i] ) / hx + ( v[i + in_stride] + v[i - in_stride] - 2 * v[i] ) / hy;
+                    uj[i] = v[i] + ( delt * lap_u * _alpha + dpsi / 2. );
+                }
+            }
+            if ( bounds ) {
+                double min = bounds[0], max = bounds[1], a2max = bounds[2];
+                for ( int i = done; uj && i < b; ++i ) {
+                    min = uj[i] < min ? uj[i] : min;
+                    max = uj[i] > max ? uj[i] : max;
+                }
+                if ( !Cell::isotropic ) {
+                    for ( int i = done; i < b; ++i ) {
+                        a2max = a2[s][i] > a2max ? a2[s][i] : a2max;
+                    }
+                }
+                bounds[0] = min;
+                bounds[1] = max;
+                bounds[2] = a2max;
+            }
+        }
+        if ( origin ) {
+            // pairs with the cell east and with the row before; octant quadrants pair their last cell with
+            // its image below the diagonal, that is the cell before on the next row, counted there
+            const double * o = origin + ( j - out_first ) * out_stride, * uj_before = uj - out_stride, * o_before = o - out_stride;
+            const int before = j > j0 ? row_end ( j - 1, 0 ) : 0;
+            // the pairs with the row before are summed apart, as seams sums them
+            double east = 0., south = 0., change = bounds[3];
+            for ( int i = 0; i < end; ++i ) {
+                const double du = uj[i] - o[i];
+                change = std::max ( change, std::abs ( du ) );
+                if ( i + 1 < end ) {
+                    const double dx = uj[i + 1] - o[i + 1] - du;
+                    east += dx * dx;
+                }
+                if ( i < before ) {
+                    const double dy = du - ( uj_before[i] - o_before[i] );
+                    south += _octant && i == j - 1 ? 2. * dy * dy : dy * dy;
+                }
+            }
+            _energy[j] = east + south;
+            bounds[3] = change;
+            if ( j == j0 && j0 > 0 ) {
+                _seams[j] = 1u;
+            }
+        }
+    }
+}
+
+// the pairs step_rows left between rows written by different calls, once all of them are written
+template<class ApproximationT, class Boundary, class Cell, class Spacing>
+void PureMetal::StencilKernel<ApproximationT, Boundary, Cell, Spacing>::seams ( const Field * u0_field, const Field * u_field )
+{
+    if ( !_watch ) {
+        return;
+    }
+    const int & Nx = _approximation->size ( 0 );
+    const int & Ny = _approximation->size ( 1 );
+    for ( int j = 1; j < Ny; ++j ) {
+        if ( !_seams[j] ) {
+            continue;
+        }
+        _seams[j] = 0u;
+        const double * u = u_field->data() + j * u_field->stride(), * o = u0_field->data() + j * u0_field->stride();
+        const double * u_before = u - u_field->stride(), * o_before = o - u0_field->stride();
+        const int before = _octant ? std::min ( Nx, j ) : Nx;
+        double south = 0.;
+        for ( int i = 0; i < before; ++i ) {
+            const double dy = u[i] - o[i] - ( u_before[i] - o_before[i] );
+            south += _octant && i == j - 1 ? 2. * dy * dy : dy * dy;
+        }
+        _energy[j] += south;
+    }
+}
+
+template<class ApproximationT, class Boundary, class Cell, class Spacing>
+bool PureMetal::StencilKernel<ApproximationT, Boundary, Cell, Spacing>::bounds ( double & min, double & max ) const
+{
+    min = _bounds[0];
+    max = _bounds[1];
+    for ( unsigned thread = 1u; thread < _approximation->threads(); ++thread ) {
+        min = _bounds[4u * thread] < min ? _bounds[4u * thread] : min;
+        max = _bounds[4u * thread + 1u] > max ? _bounds[4u * thread + 1u] : max;
+    }
+    return ! std::isnan ( min );
+}
+
+template<class ApproximationT, class Boundary, class Cell, class Spacing>
+double PureMetal::StencilKernel<ApproximationT, Boundary, Cell, Spacing>::max_a2() const
+{
+    double a2 = _bounds[2];
+    for ( unsigned thread = 1u; thread < _approximation->threads(); ++thread ) {
+        a2 = std::max ( a2, _bounds[4u * thread + 2u] );
+    }
+    return a2;
+}
+
+// the first step scans every block
+template<class ApproximationT, class Boundary, class Cell, class Spacing>
+void PureMetal::StencilKernel<ApproximationT, Boundary, Cell, Spacing>::narrow_band ( const double & delta, const unsigned & margin, const unsigned & interval )
+{
+    const unsigned blocks = _band_blocks[0] * _band_blocks[1];
+    if ( !_band_active ) {
+        _band_interface = new unsigned char[blocks];
+        _band_active = new unsigned char[blocks];
+    }
+    std::fill ( _band_interface, _band_interface + blocks, 0u );
+    std::fill ( _band_active, _band_active + blocks, 1u );
+    _band_delta = delta;
+    _band_margin = margin;
+    _band_interval = interval;
+    _band_age = interval + 1u;
+}
+
+template<class ApproximationT, class Boundary, class Cell, class Spacing>
+double PureMetal::StencilKernel<ApproximationT, Boundary, Cell, Spacing>::active_fraction() const
+{
+    return _active_fraction;
+}
+
+// interface blocks may have moved anywhere: the band starts over from every block
+template<class ApproximationT, class Boundary, class Cell, class Spacing>
+void PureMetal::StencilKernel<ApproximationT, Boundary, Cell, Spacing>::invalidate()
+{
+    if ( _band_active ) {
+        narrow_band ( _band_delta, _band_margin, _band_interval );
+    }
+}
+
+template<class ApproximationT, class Boundary, class Cell, class Spacing>
+void PureMetal::StencilKernel<ApproximationT, Boundary, Cell, Spacing>::watch_divergence()
+{
+    _watch = true;
+}
+
+template<class ApproximationT, class Boundary, class Cell, class Spacing>
+bool PureMetal::StencilKernel<ApproximationT, Boundary, Cell, Spacing>::divergence ( double & energy, double & change ) const
+{
+    energy = change = 0.;
+    for ( unsigned j = 0u; j < _approximation->size ( 1 ); ++j ) {
+        energy += _energy[j];
+    }
+    for ( unsigned thread = 0u; thread < _approximation->threads(); ++thread ) {
+        change = std::max ( change, _bounds[4u * thread + 3u] );
+    }
+    return _watch;
+}
+
+// blocked steps need u at their intermediate levels, so the wrapping kernel configures single steps
+template<class ApproximationT, class Boundary, class Cell, class Spacing>
+bool PureMetal::StencilKernel<ApproximationT, Boundary, Cell, Spacing>::leave_u()
+{
+    _leave_u = true;
+    return true;
+}
+
+template<class ApproximationT, class Boundary, class Cell, class Spacing>
+void PureMetal::StencilKernel<ApproximationT, Boundary, Cell, Spacing>::derive ( const Field * psi, Field * psix, Field * psiy, Field * n2, Field * a, Field * a2, Field * bxy ) const
+{
+    const unsigned & Nx = _approximation->size ( 0 );
+    const unsigned stride = Nx + 2u * PUREMETAL_HALO;
+    _approximation->parallel_for ( _approximation->size ( 1 ), [ & ] ( const unsigned & j0, const unsigned & j1, const unsigned & ) {
+        for ( unsigned j = j0; j < j1; ++j ) {
+            for ( unsigned i = 0u; i < Nx; ++i ) {
+                // derived fields are never interleaved
+                const unsigned k = j * stride + i;
+                const double x = psi->x ( i, j ), y = psi->y ( i, j );
+                double n2_k, a_k, bxy_k;
+                _cell ( x, y, n2_k, a_k, bxy_k );
+                if ( psix ) psix->data() [k] = x;
+                if ( psiy ) psiy->data() [k] = y;
+                if ( n2 ) n2->data() [k] = n2_k;
+                if ( a ) a->data() [k] = a_k;
+                if ( a2 ) a2->data() [k] = a_k * a_k;
+                if ( bxy ) bxy->data() [k] = bxy_k;
+            }
+        }
+    } );
+    for ( Field * field : { psix, psiy, n2, a, a2, bxy } ) {
+        if ( field ) {
+            field->fill_boundary();
+        }
+    }
+}
+
+#endif // PUREMETAL_STENCILKERNEL_HPP
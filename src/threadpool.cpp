@@ -0,0 +1,152 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "threadpool.hpp"
+
+namespace
+{
+thread_local bool in_pool = false;
+}
+
+PureMetal::ThreadPool::ThreadPool ( const unsigned & size )
+    : _workers (),
+      _mutex (),
+      _start (),
+      _done (),
+      _task ( nullptr ),
+      _context ( nullptr ),
+      _generation ( 0u ),
+      _pending ( 0u ),
+      _stop ( false ),
+      _deques ( new Deque[size] ),
+      _statistics ( new Statistics[size] ),
+      _busy ( new double[size] )
+{
+    reset_statistics();
+    for ( unsigned thread = 1u; thread < size; ++thread ) {
+        _workers.emplace_back ( &ThreadPool::work, this, thread );
+    }
+}
+
+PureMetal::ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock ( _mutex );
+        _stop = true;
+    }
+    _start.notify_all();
+    for ( std::thread & worker : _workers ) {
+        worker.join();
+    }
+    delete [] _busy;
+    delete [] _statistics;
+    delete [] _deques;
+}
+
+void PureMetal::ThreadPool::work ( const unsigned & thread )
+{
+    in_pool = true;
+    unsigned generation = 0u;
+    while ( true ) {
+        Task task;
+        void * context;
+        {
+            std::unique_lock<std::mutex> lock ( _mutex );
+            _start.wait ( lock, [ & ] {
+                return _stop || _generation != generation;
+            } );
+            if ( _stop ) {
+                return;
+            }
+            generation = _generation;
+            task = _task;
+            context = _context;
+        }
+        task ( context, thread );
+        {
+            std::lock_guard<std::mutex> lock ( _mutex );
+            if ( --_pending == 0u ) {
+                _done.notify_one();
+            }
+        }
+    }
+}
+
+// runs task ( thread ) once on every thread of the pool, the caller being thread 0, and waits for all of them
+void PureMetal::ThreadPool::run ( Task task, void * context )
+{
+    {
+        std::lock_guard<std::mutex> lock ( _mutex );
+        _task = task;
+        _context = context;
+        _pending = _workers.size();
+        ++_generation;
+    }
+    _start.notify_all();
+    in_pool = true;
+    task ( context, 0u );
+    in_pool = false;
+    std::unique_lock<std::mutex> lock ( _mutex );
+    _done.wait ( lock, [ & ] {
+        return _pending == 0u;
+    } );
+}
+
+bool PureMetal::ThreadPool::inside()
+{
+    return in_pool;
+}
+
+void PureMetal::ThreadPool::reset_statistics()
+{
+    for ( unsigned thread = 0u; thread < size(); ++thread ) {
+        _statistics[thread] = Statistics { 0., 0., 0ul, 0ul };
+    }
+}
+
+// takes the first tile left to thread
+bool PureMetal::ThreadPool::pop ( const unsigned & thread, unsigned & tile )
+{
+    std::atomic<unsigned long long> & range = _deques[thread].range;
+    unsigned long long current = range.load ( std::memory_order_relaxed );
+    while ( ( current >> 32 ) < ( current & 0xffffffffull ) ) {
+        if ( range.compare_exchange_weak ( current, current + ( 1ull << 32 ), std::memory_order_relaxed ) ) {
+            tile = static_cast<unsigned> ( current >> 32 );
+            return true;
+        }
+    }
+    return false;
+}
+
+// takes the last tile left to the first other thread, starting from the next one, that has any
+bool PureMetal::ThreadPool::steal ( const unsigned & thread, unsigned & tile )
+{
+    const unsigned threads = size();
+    for ( unsigned k = 1u; k < threads; ++k ) {
+        std::atomic<unsigned long long> & range = _deques[ ( thread + k ) % threads].range;
+        unsigned long long current = range.load ( std::memory_order_relaxed );
+        while ( ( current >> 32 ) < ( current & 0xffffffffull ) ) {
+            if ( range.compare_exchange_weak ( current, current - 1ull, std::memory_order_relaxed ) ) {
+                tile = static_cast<unsigned> ( current & 0xffffffffull ) - 1u;
+                return true;
+            }
+        }
+    }
+    return false;
+}
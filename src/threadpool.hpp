@@ -0,0 +1,182 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PUREMETAL_THREADPOOL_HPP
+#define PUREMETAL_THREADPOOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace PureMetal
+{
+
+class ThreadPool
+{
+public:
+    typedef void ( *Task ) ( void * context, const unsigned & thread );
+
+    // accumulated over parallel_tiles calls: idle is the time a thread spent in a call without a tile to run
+    struct Statistics {
+        double busy;
+        double idle;
+        unsigned long tiles;
+        unsigned long steals;
+    };
+
+private:
+    // tiles [begin,end) still owed by a thread, packed as begin << 32 | end so that the owner taking
+    // the front and thieves taking the back agree through a single compare and swap; padded to a cache line
+    struct Deque {
+        std::atomic<unsigned long long> range;
+        char padding[64 - sizeof ( std::atomic<unsigned long long> )];
+    };
+
+    std::vector<std::thread> _workers;
+    std::mutex _mutex;
+    std::condition_variable _start;
+    std::condition_variable _done;
+    Task _task;
+    void * _context;
+    unsigned _generation;
+    unsigned _pending;
+    bool _stop;
+    Deque * _deques;
+    Statistics * _statistics;
+    double * _busy;
+
+    ThreadPool ( const ThreadPool & other ) = delete;
+    ThreadPool & operator= ( const ThreadPool & other ) = delete;
+    bool operator== ( const ThreadPool & other ) const = delete;
+
+    void work ( const unsigned & thread );
+
+    template<class Callable> inline static void invoke ( void * callable, const unsigned & thread );
+
+    bool pop ( const unsigned & thread, unsigned & tile );
+    bool steal ( const unsigned & thread, unsigned & tile );
+
+public:
+    ThreadPool ( const unsigned & size );
+    ~ThreadPool();
+
+    inline unsigned size() const;
+
+    void run ( Task task, void * context );
+    template<class Function> inline void parallel_for ( const unsigned & n, const Function & function );
+    template<class Function> inline void parallel_tiles ( const unsigned & n, const Function & function );
+
+    inline const Statistics & statistics ( const unsigned & thread ) const;
+    void reset_statistics();
+
+    static bool inside();
+
+    // tiles a parallel_tiles call is cut into per thread, enough for the fast threads to take over the slow ones' tail
+    static const unsigned tiles_per_thread = 8u;
+};
+
+}
+
+unsigned PureMetal::ThreadPool::size() const
+{
+    return _workers.size() + 1u;
+}
+
+// splits [0,n) in size() contiguous chunks and calls function ( begin, end, thread ) on each of them;
+// the partition only depends on n and size(), calls from within a task run serially
+template<class Function>
+void PureMetal::ThreadPool::parallel_for ( const unsigned & n, const Function & function )
+{
+    const unsigned threads = size();
+    if ( threads == 1u || n < 2u || inside() ) {
+        function ( 0u, n, 0u );
+        return;
+    }
+    auto chunk = [ & ] ( const unsigned & thread ) {
+        const unsigned begin = static_cast<unsigned> ( static_cast<unsigned long> ( n ) * thread / threads );
+        const unsigned end = static_cast<unsigned> ( static_cast<unsigned long> ( n ) * ( thread + 1u ) / threads );
+        if ( begin < end ) {
+            function ( begin, end, thread );
+        }
+    };
+    run ( &ThreadPool::invoke<decltype ( chunk ) >, &chunk );
+}
+
+// splits [0,n) in tiles of contiguous items and calls function ( begin, end, thread ) on each of them;
+// every thread starts from the tiles parallel_for would give it and steals from the others once done,
+// so the partition varies from call to call and function must not depend on it
+template<class Function>
+void PureMetal::ThreadPool::parallel_tiles ( const unsigned & n, const Function & function )
+{
+    const unsigned threads = size();
+    if ( threads == 1u || n < 2u || inside() ) {
+        function ( 0u, n, 0u );
+        return;
+    }
+    const unsigned tiles = std::min ( n, tiles_per_thread * threads );
+    for ( unsigned thread = 0u; thread < threads; ++thread ) {
+        const unsigned long long begin = static_cast<unsigned long long> ( tiles ) * thread / threads;
+        const unsigned long long end = static_cast<unsigned long long> ( tiles ) * ( thread + 1u ) / threads;
+        _deques[thread].range.store ( begin << 32 | end, std::memory_order_relaxed );
+    }
+    auto work = [ & ] ( const unsigned & thread ) {
+        double busy = 0.;
+        auto execute = [ & ] ( const unsigned & tile ) {
+            const auto start = std::chrono::steady_clock::now();
+            function ( static_cast<unsigned> ( static_cast<unsigned long> ( n ) * tile / tiles ),
+                       static_cast<unsigned> ( static_cast<unsigned long> ( n ) * ( tile + 1u ) / tiles ), thread );
+            busy += std::chrono::duration<double> ( std::chrono::steady_clock::now() - start ).count();
+            ++_statistics[thread].tiles;
+        };
+        unsigned tile;
+        while ( pop ( thread, tile ) ) {
+            execute ( tile );
+        }
+        while ( steal ( thread, tile ) ) {
+            execute ( tile );
+            ++_statistics[thread].steals;
+        }
+        _busy[thread] = busy;
+    };
+    const auto start = std::chrono::steady_clock::now();
+    run ( &ThreadPool::invoke<decltype ( work ) >, &work );
+    const double elapsed = std::chrono::duration<double> ( std::chrono::steady_clock::now() - start ).count();
+    for ( unsigned thread = 0u; thread < threads; ++thread ) {
+        _statistics[thread].busy += _busy[thread];
+        _statistics[thread].idle += std::max ( 0., elapsed - _busy[thread] );
+    }
+}
+
+const PureMetal::ThreadPool::Statistics & PureMetal::ThreadPool::statistics ( const unsigned & thread ) const
+{
+    return _statistics[thread];
+}
+
+// tasks are passed as plain function and context pointers so that dispatching never allocates
+template<class Callable>
+void PureMetal::ThreadPool::invoke ( void * callable, const unsigned & thread )
+{
+    ( *static_cast<Callable *> ( callable ) ) ( thread );
+}
+
+#endif // PUREMETAL_THREADPOOL_HPP
@@ -0,0 +1,121 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "timestepcontroller.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "approximation.hpp"
+#include "decomposition.hpp"
+#include "field.hpp"
+
+// bounds of the change of delt from one timestep to the next
+const double PureMetal::TimestepController::min_factor = .2;
+const double PureMetal::TimestepController::max_factor = 5.;
+
+PureMetal::TimestepController::TimestepController ( const Approximation * approximation, const double & alpha, const double & tolerance, const double & safety, const double & delt_min, const double & delt_max, const bool & implicit )
+    : _approximation ( approximation ),
+      _alpha ( alpha ),
+      _implicit ( implicit ),
+      _tolerance ( tolerance ),
+      _safety ( safety ),
+      _delt_min ( delt_min ),
+      _delt_max ( delt_max ),
+      _partials ( new double[approximation->threads()] ),
+      _delt ( 0. ),
+      _error ( 0. ),
+      _limit ( 0. ),
+      _rejected ( 0u )
+{
+}
+
+PureMetal::TimestepController::~TimestepController()
+{
+    delete [] _partials;
+}
+
+// the laplacians of the kernel divide the differences by the spacing, the limit is linear in it
+double PureMetal::TimestepController::stability_limit ( const double & a2 ) const
+{
+    return _safety / ( 2. * std::max ( _alpha, a2 ) * ( 1. / _approximation->spacing ( 0 ) + 1. / _approximation->spacing ( 1 ) ) );
+}
+
+void PureMetal::TimestepController::start ( const double & delt )
+{
+    _limit = _implicit ? std::numeric_limits<double>::infinity() : stability_limit ( 1. );
+    _delt = delt > 0. ? delt : stability_limit ( 1. );
+    if ( _delt_max > 0. ) {
+        _delt = std::min ( _delt, _delt_max );
+    }
+    _delt = std::max ( _delt, _delt_min );
+    _error = 0.;
+    _rejected = 0u;
+}
+
+// every rank sees the global error and a2, and takes the same decision
+bool PureMetal::TimestepController::accept ( const Field * psi0, const Field * u0, const Field * psi, const Field * u, const Field * psi_next, const Field * u_next, const double & delt, const double & a2 )
+{
+    const unsigned & Nx = _approximation->size ( 0 );
+    const unsigned & Ny = _approximation->size ( 1 );
+    double values[2] = { 0., a2 };
+    // ( delt / 2 ) ( f ( y ) - f ( y0 ) ), with delt f ( y0 ) = y - y0 and delt f ( y ) = y_next - y
+    std::fill ( _partials, _partials + _approximation->threads(), 0. );
+    _approximation->parallel_tiles ( Ny, [ & ] ( const unsigned & j0, const unsigned & j1, const unsigned & thread ) {
+        double error = 0.;
+        auto scan = [ & ] ( const Field * field0, const Field * field, const Field * field_next ) {
+            for ( unsigned j = j0; j < j1; ++j ) {
+                const double * y0 = field0->data() + j * field0->stride();
+                const double * y = field->data() + j * field->stride();
+                const double * y_next = field_next->data() + j * field_next->stride();
+                // octant quadrants only keep the cells above the diagonal up to date
+                for ( unsigned i = 0u; i < ( _approximation->octant() ? std::min ( Nx, j + 1u ) : Nx ); ++i ) {
+                    error = std::max ( error, std::abs ( ( y_next[i] - y[i] ) - ( y[i] - y0[i] ) ) );
+                }
+            }
+        };
+        scan ( psi0, psi, psi_next );
+        scan ( u0, u, u_next );
+        _partials[thread] = std::max ( _partials[thread], .5 * error );
+    } );
+    for ( unsigned thread = 0u; thread < _approximation->threads(); ++thread ) {
+        values[0] = std::max ( values[0], _partials[thread] );
+    }
+    if ( Decomposition * decomposition = _approximation->decomposition() ) {
+        decomposition->max ( values, 2u );
+    }
+    _error = values[0];
+    _limit = _implicit ? std::numeric_limits<double>::infinity() : stability_limit ( values[1] );
+
+    // delt_min is taken whatever the error
+    const bool accepted = ( delt <= _limit && _error <= _tolerance ) || ! ( delt > _delt_min );
+    double factor = _error > 0. ? _safety * std::sqrt ( _tolerance / _error ) : max_factor;
+    factor = std::min ( std::max ( factor, min_factor ), max_factor );
+    _delt = std::min ( delt * factor, _limit );
+    if ( _delt_max > 0. ) {
+        _delt = std::min ( _delt, _delt_max );
+    }
+    _delt = std::max ( _delt, _delt_min );
+    if ( !accepted ) {
+        ++_rejected;
+    }
+    return accepted;
+}
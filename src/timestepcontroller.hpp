@@ -0,0 +1,104 @@
+/*
+ * PureMetal - A simple program for pure metal phase field simulations.
+ * Copyright (C) 2017  Jon Matteo Church scjmc@leeds.ac.uk
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef PUREMETAL_TIMESTEPCONTROLLER_HPP
+#define PUREMETAL_TIMESTEPCONTROLLER_HPP
+
+namespace PureMetal
+{
+
+class Approximation;
+class Field;
+
+// chooses the delt of each timestep of an adaptive run. A timestep of delt is accepted when delt is within
+// the explicit stability limit, safety / ( 2 max ( alpha, a2 ) ( 1 / hx + 1 / hy ) ) with a2 the largest
+// one the kernel stepped with, and when its local error is within tolerance. The error of forward Euler,
+// delt^2 / 2 times the second derivative of psi and u, is estimated within the timestep by the embedded
+// Heun step: a further step of delt from the new state gives delt f ( y ), and the error is half its
+// difference from the increment delt f ( y0 ). Every timestep, the first one included, is thus checked at
+// the cost of a second kernel evaluation. The next delt aims at the tolerance and stays within the limit
+// and [delt_min, delt_max]. Implicit schemes have no limit, the error alone bounds their delt
+class TimestepController
+{
+    const Approximation * _approximation;
+    const double _alpha;
+    const bool _implicit;
+    const double _tolerance;
+    const double _safety;
+    const double _delt_min;
+    const double _delt_max;
+    double * _partials;
+    double _delt;
+    double _error;
+    double _limit;
+    unsigned _rejected;
+
+    TimestepController ( const TimestepController & other ) = delete;
+    TimestepController & operator= ( const TimestepController & other ) = delete;
+    bool operator== ( const TimestepController & other ) const = delete;
+
+    double stability_limit ( const double & a2 ) const;
+
+public:
+    // delt_max 0 leaves delt unbounded above
+    TimestepController ( const Approximation * approximation, const double & alpha, const double & tolerance, const double & safety, const double & delt_min, const double & delt_max, const bool & implicit );
+    ~TimestepController();
+
+    // the first delt, 0 for the stability limit of an isotropic grid
+    void start ( const double & delt );
+    // psi0 and u0 were advanced by delt into psi and u, with a2 the largest the kernel stepped with, and
+    // psi and u by delt again into psi_next and u_next. Returns whether to keep psi and u, delt() being
+    // the one to take next or to retry with
+    bool accept ( const Field * psi0, const Field * u0, const Field * psi, const Field * u, const Field * psi_next, const Field * u_next, const double & delt, const double & a2 );
+
+    inline const double & delt() const;
+    inline const double & error() const;
+    inline const double & limit() const;
+    inline const unsigned & rejected() const;
+
+    static const double min_factor;
+    static const double max_factor;
+};
+
+}
+
+const double & PureMetal::TimestepController::delt() const
+{
+    return _delt;
+}
+
+// estimated local error of the last timestep, max over psi and u
+const double & PureMetal::TimestepController::error() const
+{
+    return _error;
+}
+
+// stability limit of the last timestep
+const double & PureMetal::TimestepController::limit() const
+{
+    return _limit;
+}
+
+const unsigned & PureMetal::TimestepController::rejected() const
+{
+    return _rejected;
+}
+
+#endif // PUREMETAL_TIMESTEPCONTROLLER_HPP
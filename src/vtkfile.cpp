@@ -29,6 +29,16 @@
 
 #include "field.hpp"
 
+PureMetal::VtkFile::VtkFile ( const std::string & path, const unsigned & timestep )
+    : _path ( path ),
+      _data ( "data" ),
+      _grid ( )
+{
+    std::stringstream stream;
+    stream << "t" << std::setw ( PUREMETAL_TIME_WIDTH ) << std::setfill ( '0' ) << timestep << ".vti";
+    _name = stream.str();
+}
+
 PureMetal::VtkFile::~VtkFile()
 {
     if ( _grid ) {
@@ -48,8 +58,29 @@ void PureMetal::VtkFile::read ( PureMetal::Field * psi, PureMetal::Field * u )
     reader->SetFileName ( abs_path().c_str() );
     reader->Update();
     vtkImageData * grid = reader->GetOutput();
-    grid->GetPointData()->GetArray ( "psi" )->GetTuple ( 0, psi->data() );
-    grid->GetPointData()->GetArray ( "u" )->GetTuple ( 0, u->data() );
+    const int * dims = grid->GetDimensions();
+    vtkDataArray * psi_array = grid->GetPointData()->GetArray ( "psi" );
+    vtkDataArray * u_array = grid->GetPointData()->GetArray ( "u" );
+    for ( int j = 0; j < dims[1]; ++j ) {
+        for ( int i = 0; i < dims[0]; ++i ) {
+            psi->data() [j * psi->stride() + i] = psi_array->GetTuple1 ( j * dims[0] + i );
+            u->data() [j * u->stride() + i] = u_array->GetTuple1 ( j * dims[0] + i );
+        }
+    }
+    psi->fill_boundary();
+    u->fill_boundary();
+    reader->Delete();
+}
+
+// dimensions of the grid saved, which grow with the Growth of the grid
+void PureMetal::VtkFile::size ( unsigned * size )
+{
+    vtkXMLImageDataReader * reader = vtkXMLImageDataReader::New();
+    reader->SetFileName ( abs_path().c_str() );
+    reader->Update();
+    const int * dims = reader->GetOutput()->GetDimensions();
+    size[0] = dims[0];
+    size[1] = dims[1];
     reader->Delete();
 }
 
@@ -74,13 +105,17 @@ void PureMetal::VtkFile::add_time ( const double & time )
 
 }
 
-void PureMetal::VtkFile::add_scalar ( const std::string & name, const double * data )
+void PureMetal::VtkFile::add_scalar ( const std::string & name, const Field * field )
 {
     const auto &n = _grid->GetNumberOfPoints();
+    const int * dims = _grid->GetDimensions();
     vtkSmartPointer< vtkDoubleArray> array = vtkSmartPointer<vtkDoubleArray>::New();
-    
+
+    // only the interior is written, ghost cells are skipped
     double * tmp = new double[n];
-    std::copy(data, data+n, tmp);
+    for ( int j = 0; j < dims[1]; ++j ) {
+        std::copy ( field->data() + j * field->stride(), field->data() + j * field->stride() + dims[0], tmp + j * dims[0] );
+    }
     array->SetNumberOfComponents ( 1 );
     array->SetNumberOfTuples ( _grid->GetNumberOfPoints() );
     array->SetArray ( tmp, _grid->GetNumberOfPoints(), 0, 1 );
@@ -47,7 +47,7 @@ class VtkFile
     bool operator== ( const VtkFile & other ) const = delete;
 
 public:
-    inline VtkFile ( const std::string & path, const unsigned & timestep );
+    VtkFile ( const std::string & path, const unsigned & timestep );
     ~VtkFile();
 
     bool exists();
@@ -56,24 +56,15 @@ public:
     inline std::string rel_path();
 
     void read ( Field * psi, Field * u );
+    void size ( unsigned * size );
     void set_grid ( const double & hx, const double & hy, const int & Nx, const int & Ny, const double & x0, const double & y0 );
     void add_time ( const double & time );
-    void add_scalar ( const std::string & name, const double * data );
+    void add_scalar ( const std::string & name, const Field * field );
     void save();
 };
 
 }
 
-PureMetal::VtkFile::VtkFile ( const std::string & path, const unsigned & timestep )
-    : _path ( path ),
-      _data ( "data" ),
-      _grid ( )
-{
-    std::stringstream stream;
-    stream << "t" << std::setw ( PUREMETAL_TIME_WIDTH ) << std::setfill ( '0' ) << timestep << ".vti";
-    _name = stream.str();
-}
-
 
 std::string PureMetal::VtkFile::abs_path()
 {
@@ -0,0 +1,82 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "approximation.hpp"
+#include "decomposition.hpp"
+#include "field.hpp"
+#include "simulation.hpp"
+#include "specifications.hpp"
+#include "threadpool.hpp"
+#include "timestepcontroller.hpp"
+
+using namespace PureMetal;
+
+namespace
+{
+
+// largest difference of the interior cells of two fields on the same grid
+double distance ( const Field * a, const Field * b, const unsigned & Nx, const unsigned & Ny )
+{
+    double distance = 0.;
+    for ( unsigned j = 0u; j < Ny; ++j ) {
+        for ( unsigned i = 0u; i < Nx; ++i ) {
+            distance = std::max ( distance, std::abs ( ( *a ) ( i, j ) - ( *b ) ( i, j ) ) );
+        }
+    }
+    return distance;
+}
+
+}
+
+// runs an adaptive input and a fixed one whose small delt makes it the reference, up to the same time: the
+// local errors of the adaptive timesteps only add up, so psi and u must end within the error tolerance
+// times the timesteps taken of the reference
+int main ( int argc, char ** argv )
+{
+    Decomposition * decomposition = new Decomposition ( &argc, &argv );
+    if ( argc != 3 || decomposition->ranks() != 1 ) {
+        std::cerr << "usage: adaptive_test <adaptive>.xml <reference>.xml, on a single rank" << std::endl;
+        delete decomposition;
+        return 1;
+    }
+
+    Specifications * adaptive_specs = new Specifications ( argv[1] );
+    Specifications * reference_specs = new Specifications ( argv[2] );
+    ThreadPool * pool = new ThreadPool ( adaptive_specs->threads() );
+
+    Simulation adaptive ( adaptive_specs, pool, decomposition );
+    adaptive.start ( adaptive_specs->delt(), adaptive_specs->max_time() );
+    while ( adaptive.next() && adaptive.stable() ) {
+    }
+    // fixed runs go on until past timestep timesteps
+    const unsigned timesteps = static_cast<unsigned> ( std::round ( reference_specs->max_time() / reference_specs->delt() ) ) - 1u;
+    Simulation reference ( reference_specs, pool, decomposition );
+    reference.start ( reference_specs->delt(), timesteps );
+    while ( reference.next() && reference.stable() ) {
+    }
+
+    bool passed = true;
+    if ( std::abs ( adaptive.time() - adaptive_specs->max_time() ) > 1e-12 || std::abs ( reference.time() - adaptive_specs->max_time() ) > 1e-12 ) {
+        std::cerr << "the adaptive run stopped at time " << adaptive.time() << ", the reference at " << reference.time();
+        std::cerr << " instead of " << adaptive_specs->max_time() << std::endl;
+        passed = false;
+    } else {
+        // the grid both runs were given
+        const Approximation * approximation = Approximation::New ( adaptive_specs->simulation_type(), adaptive_specs->upper(), adaptive_specs->lower(), adaptive_specs->spacing(), nullptr );
+        const unsigned & Nx = approximation->size ( 0 );
+        const unsigned & Ny = approximation->size ( 1 );
+        const double error = std::max ( distance ( adaptive.psi(), reference.psi(), Nx, Ny ), distance ( adaptive.u(), reference.u(), Nx, Ny ) );
+        delete approximation;
+        const double bound = adaptive_specs->error_tolerance() * adaptive.timestep();
+        std::cout << adaptive.timestep() << " adaptive timesteps, " << adaptive.controller()->rejected() << " rejected: error " << error;
+        std::cout << " against the reference, bound " << bound << std::endl;
+        passed = error <= bound;
+    }
+
+    delete pool;
+    delete reference_specs;
+    delete adaptive_specs;
+    delete decomposition;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,56 @@
+#include <iostream>
+
+#include "decomposition.hpp"
+#include "divergencemonitor.hpp"
+#include "simulation.hpp"
+#include "specifications.hpp"
+#include "threadpool.hpp"
+
+using namespace PureMetal;
+
+// repeats a run whose delt is unstable: whichever threads its rows go to, the divergence monitor must
+// declare divergence at the same timestep, from the same energy
+int main ( int argc, char ** argv )
+{
+    Decomposition * decomposition = new Decomposition ( &argc, &argv );
+    if ( argc != 2 ) {
+        std::cerr << "usage: divergence_test <input>.xml" << std::endl;
+        delete decomposition;
+        return 1;
+    }
+    const unsigned runs = 10u;
+
+    Specifications * specifications = new Specifications ( argv[1] );
+    ThreadPool * pool = new ThreadPool ( specifications->threads() );
+    const unsigned timesteps = 1u + static_cast<unsigned> ( specifications->max_time() / specifications->delt() );
+    unsigned timestep = 0u;
+    double energy = 0.;
+    bool passed = true;
+    for ( unsigned run = 0u; run < runs && passed; ++run ) {
+        Simulation simulation ( specifications, pool, decomposition );
+        simulation.start ( specifications->delt(), timesteps );
+        while ( simulation.next() && simulation.stable() ) {
+        }
+        const DivergenceMonitor * monitor = simulation.monitor();
+        if ( !monitor || !monitor->diverged() ) {
+            std::cerr << "run " << run << " did not diverge" << std::endl;
+            passed = false;
+        } else if ( run == 0u ) {
+            timestep = monitor->timestep();
+            energy = monitor->energy();
+        } else if ( monitor->timestep() != timestep || monitor->energy() != energy ) {
+            std::cerr.precision ( 17 );
+            std::cerr << "run " << run << " diverged at timestep " << monitor->timestep() << " with energy " << monitor->energy();
+            std::cerr << ", run 0 at timestep " << timestep << " with energy " << energy << std::endl;
+            passed = false;
+        }
+    }
+    if ( passed ) {
+        std::cout << runs << " runs diverged at timestep " << timestep << std::endl;
+    }
+
+    delete pool;
+    delete specifications;
+    delete decomposition;
+    return passed ? 0 : 1;
+}